@@ -0,0 +1,159 @@
+#include "ArchetypeStorage.h"
+
+#include "Game.h"
+
+namespace EcoSort {
+
+    ArchetypeStorage::~ArchetypeStorage() {
+        for (ArchetypeEntity entity = 0; entity < m_locations.size(); entity++) {
+            if (m_locations[entity].alive) destroyEntity(entity);
+        }
+    }
+
+    ArchetypeEntity ArchetypeStorage::createEntity() {
+        ArchetypeEntity entity;
+        if (!m_freeEntities.empty()) {
+            entity = m_freeEntities.back();
+            m_freeEntities.pop_back();
+        } else {
+            entity = static_cast<ArchetypeEntity>(m_locations.size());
+            m_locations.emplace_back();
+        }
+        m_locations[entity] = { nullptr, 0, 0, true };
+        return entity;
+    }
+
+    void ArchetypeStorage::destroyEntity(ArchetypeEntity entity) {
+        if (!entityExists(entity)) return;
+        if (m_locations[entity].archetype) freeRow(m_locations[entity], true);
+        m_locations[entity] = {};
+        m_freeEntities.push_back(entity);
+    }
+
+    size_t ArchetypeStorage::getChunkCount() const {
+        size_t chunks = 0;
+        for (auto& archetype : m_archetypes) chunks += archetype->chunks.size();
+        return chunks;
+    }
+
+    int ArchetypeStorage::Archetype::findType(unsigned int type) const {
+        // Archetypes rarely have more than a handful of types, so a linear search beats anything cleverer.
+        for (unsigned int i = 0; i < types.size(); i++) {
+            if (types[i] == type) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    bool ArchetypeStorage::Archetype::hasAll(const unsigned int* wanted, size_t count) const {
+        for (size_t i = 0; i < count; i++) {
+            if (findType(wanted[i]) < 0) return false;
+        }
+        return true;
+    }
+
+    void* ArchetypeStorage::Archetype::getColumn(unsigned int chunk, unsigned int type, unsigned int row) const {
+        int index = findType(type);
+        if (index < 0) return nullptr;
+        return chunks[chunk].data.get() + offsets[index] + sizes[index] * row;
+    }
+
+    ArchetypeEntity* ArchetypeStorage::Archetype::getEntities(unsigned int chunk) const {
+        return reinterpret_cast<ArchetypeEntity*>(chunks[chunk].data.get() + entityOffset);
+    }
+
+    ArchetypeStorage::Archetype* ArchetypeStorage::getArchetype(const std::vector<unsigned int>& types) {
+        for (auto& archetype : m_archetypes) {
+            if (archetype->types == types) return archetype.get();
+        }
+
+        auto archetype = std::make_unique<Archetype>();
+        archetype->types = types;
+
+        size_t rowSize = sizeof(ArchetypeEntity);
+        for (unsigned int type : types) {
+            rowSize += m_typeInfos[type].size;
+            if (m_typeInfos[type].alignment > alignof(std::max_align_t)) {
+                LOGGER.warn("Component type {} needs {} byte alignment, more than chunks are allocated with", type,
+                    m_typeInfos[type].alignment);
+            }
+        }
+        // Padding between columns is at most an alignment per column, so it is left out of the row size and made up
+        // for by the capacity being rounded down.
+        archetype->capacity = static_cast<unsigned int>(std::max<size_t>(
+            (CHUNK_SIZE - types.size() * alignof(std::max_align_t)) / rowSize, 1));
+
+        size_t offset = 0;
+        for (unsigned int type : types) {
+            const TypeInfo& info = m_typeInfos[type];
+            offset = (offset + info.alignment - 1) / info.alignment * info.alignment;
+            archetype->offsets.push_back(offset);
+            archetype->sizes.push_back(info.size);
+            offset += info.size * archetype->capacity;
+        }
+        offset = (offset + alignof(ArchetypeEntity) - 1) / alignof(ArchetypeEntity) * alignof(ArchetypeEntity);
+        archetype->entityOffset = offset;
+
+        m_archetypes.push_back(std::move(archetype));
+        return m_archetypes.back().get();
+    }
+
+    ArchetypeStorage::Location ArchetypeStorage::allocateRow(Archetype* archetype, ArchetypeEntity entity) {
+        if (archetype->chunks.empty() || archetype->chunks.back().count == archetype->capacity) {
+            size_t size = archetype->entityOffset + sizeof(ArchetypeEntity) * archetype->capacity;
+            archetype->chunks.push_back({ std::make_unique<std::byte[]>(size), 0 });
+        }
+
+        unsigned int chunk = static_cast<unsigned int>(archetype->chunks.size() - 1);
+        unsigned int row = archetype->chunks[chunk].count++;
+        archetype->getEntities(chunk)[row] = entity;
+        return { archetype, chunk, row, true };
+    }
+
+    ArchetypeStorage::Location ArchetypeStorage::move(ArchetypeEntity entity, Archetype* archetype) {
+        Location from = m_locations[entity];
+        Location to = allocateRow(archetype, entity);
+
+        if (from.archetype) {
+            for (unsigned int type : from.archetype->types) {
+                void* source = from.archetype->getColumn(from.chunk, type, from.row);
+                if (void* destination = archetype->getColumn(to.chunk, type, to.row)) {
+                    m_typeInfos[type].moveConstruct(destination, source);
+                }
+                m_typeInfos[type].destroy(source);
+            }
+            freeRow(from, false);
+        }
+
+        m_locations[entity] = to;
+        return to;
+    }
+
+    void ArchetypeStorage::freeRow(const Location& location, bool destroyComponents) {
+        Archetype* archetype = location.archetype;
+
+        if (destroyComponents) {
+            for (unsigned int type : archetype->types) {
+                m_typeInfos[type].destroy(archetype->getColumn(location.chunk, type, location.row));
+            }
+        }
+
+        unsigned int lastChunk = static_cast<unsigned int>(archetype->chunks.size() - 1),
+                     lastRow = archetype->chunks[lastChunk].count - 1;
+
+        if (location.chunk != lastChunk || location.row != lastRow) {
+            for (unsigned int type : archetype->types) {
+                void* last = archetype->getColumn(lastChunk, type, lastRow);
+                m_typeInfos[type].moveConstruct(archetype->getColumn(location.chunk, type, location.row), last);
+                m_typeInfos[type].destroy(last);
+            }
+
+            ArchetypeEntity moved = archetype->getEntities(lastChunk)[lastRow];
+            archetype->getEntities(location.chunk)[location.row] = moved;
+            m_locations[moved].chunk = location.chunk;
+            m_locations[moved].row = location.row;
+        }
+
+        if (--archetype->chunks[lastChunk].count == 0) archetype->chunks.pop_back();
+    }
+
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace EcoSort {
+
+    using ArchetypeEntity = unsigned int;
+
+    // Component storage that groups entities by the exact set of components they have. Each set, or archetype, keeps
+    // its entities in fixed size chunks, and each chunk stores every component type in its own column, so iterating a
+    // query streams through contiguous arrays of just the components it asks for instead of looking each entity up.
+    //
+    // Adding or removing a component moves the entity to another archetype, which makes structural changes dearer
+    // than in BOO in exchange for much faster iteration and O(1) access to any component through the entity's
+    // location. Like BOO, nothing is thread safe, and components must be movable.
+    //
+    // This is only used by the storage benchmark. Scene still stores everything in BOO, see the README for what making
+    // this a backend for it would take.
+    class ArchetypeStorage {
+    public:
+
+        // Bytes per chunk, picked so a chunk of the largest components still holds a useful number of entities while
+        // staying well within the L2 cache.
+        static constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+        ArchetypeStorage() = default;
+        ~ArchetypeStorage();
+
+        ArchetypeStorage(const ArchetypeStorage&) = delete;
+        ArchetypeStorage& operator=(const ArchetypeStorage&) = delete;
+
+        ArchetypeEntity createEntity();
+        void destroyEntity(ArchetypeEntity entity);
+        [[nodiscard]] bool entityExists(ArchetypeEntity entity) const {
+            return entity < m_locations.size() && m_locations[entity].alive;
+        }
+
+        // Replaces the component if the entity already has one.
+        template<typename T, typename... Args>
+        T& addComponent(ArchetypeEntity entity, Args&&... args) {
+            if (T* existing = getComponent<T>(entity)) {
+                *existing = T(std::forward<Args>(args)...);
+                return *existing;
+            }
+
+            unsigned int type = getTypeID<T>();
+            Archetype* from = m_locations[entity].archetype;
+            std::vector<unsigned int> types = from ? from->types : std::vector<unsigned int> {};
+            types.insert(std::upper_bound(types.begin(), types.end(), type), type);
+
+            Location location = move(entity, getArchetype(types));
+            void* column = location.archetype->getColumn(location.chunk, type, location.row);
+            return *new (column) T(std::forward<Args>(args)...);
+        }
+
+        template<typename T>
+        void removeComponent(ArchetypeEntity entity) {
+            if (!hasComponent<T>(entity)) return;
+
+            unsigned int type = getTypeID<T>();
+            std::vector<unsigned int> types = m_locations[entity].archetype->types;
+            types.erase(std::find(types.begin(), types.end(), type));
+            move(entity, getArchetype(types));
+        }
+
+        // Null if the entity doesn't have one. The pointer is only valid until the next structural change.
+        template<typename T>
+        T* getComponent(ArchetypeEntity entity) {
+            if (!entityExists(entity)) return nullptr;
+            const Location& location = m_locations[entity];
+            if (!location.archetype) return nullptr;
+            return static_cast<T*>(location.archetype->getColumn(location.chunk, getTypeID<T>(), location.row));
+        }
+
+        template<typename T>
+        [[nodiscard]] bool hasComponent(ArchetypeEntity entity) {
+            return getComponent<T>(entity) != nullptr;
+        }
+
+        // Call function with a reference to each of T for every entity that has them all, chunk by chunk.
+        template<typename... T, typename Function>
+        void forEach(Function&& function) {
+            const unsigned int types[] = { getTypeID<T>()... };
+            for (auto& archetype : m_archetypes) {
+                if (!archetype->hasAll(types, sizeof...(T))) continue;
+
+                for (unsigned int chunk = 0; chunk < archetype->chunks.size(); chunk++) {
+                    unsigned int count = archetype->chunks[chunk].count;
+                    if (!count) continue;
+
+                    // The columns are looked up once per chunk, after which every entity is a plain array index.
+                    std::tuple<T*...> columns = { static_cast<T*>(archetype->getColumn(chunk, getTypeID<T>(), 0))... };
+                    for (unsigned int row = 0; row < count; row++) function(std::get<T*>(columns)[row]...);
+                }
+            }
+        }
+
+        // Number of archetypes, and of chunks across all of them, for seeing how fragmented the storage is.
+        [[nodiscard]] size_t getArchetypeCount() const { return m_archetypes.size(); }
+        [[nodiscard]] size_t getChunkCount() const;
+
+    private:
+
+        // How to handle a component type without knowing it.
+        struct TypeInfo {
+            size_t size,
+                   alignment;
+            void (*moveConstruct)(void* to, void* from);
+            void (*destroy)(void* component);
+        };
+
+        struct Chunk {
+            std::unique_ptr<std::byte[]> data;
+            unsigned int count = 0;
+        };
+
+        struct Archetype {
+            // Sorted, so every set of types has exactly one archetype.
+            std::vector<unsigned int> types;
+            // The offset into a chunk of each type's column and the size of its components, in the same order as
+            // types.
+            std::vector<size_t> offsets,
+                                sizes;
+            // Where each chunk's entities are listed, which is also a column.
+            size_t entityOffset = 0;
+            unsigned int capacity = 0;
+            // Every chunk but the last is full, since a removed entity's row is filled with the last entity.
+            std::vector<Chunk> chunks;
+
+            [[nodiscard]] int findType(unsigned int type) const;
+            [[nodiscard]] bool hasAll(const unsigned int* wanted, size_t count) const;
+            // Null if the archetype doesn't have the type.
+            [[nodiscard]] void* getColumn(unsigned int chunk, unsigned int type, unsigned int row) const;
+            [[nodiscard]] ArchetypeEntity* getEntities(unsigned int chunk) const;
+        };
+
+        struct Location {
+            Archetype* archetype = nullptr;
+            unsigned int chunk = 0,
+                         row = 0;
+            bool alive = false;
+        };
+
+        static unsigned int nextTypeID() {
+            static std::atomic<unsigned int> s_next = 0;
+            return s_next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        template<typename T>
+        unsigned int getTypeID() {
+            static const unsigned int s_id = nextTypeID();
+            if (s_id >= m_typeInfos.size()) m_typeInfos.resize(s_id + 1);
+            if (!m_typeInfos[s_id].size) {
+                m_typeInfos[s_id] = {
+                    sizeof(T), alignof(T),
+                    [](void* to, void* from) { new (to) T(std::move(*static_cast<T*>(from))); },
+                    [](void* component) { static_cast<T*>(component)->~T(); }
+                };
+            }
+            return s_id;
+        }
+
+        Archetype* getArchetype(const std::vector<unsigned int>& types);
+        // Give the entity a row in archetype, moving over every component the two have in common and destroying the
+        // rest. Components only the new archetype has are left unconstructed for the caller.
+        Location move(ArchetypeEntity entity, Archetype* archetype);
+        Location allocateRow(Archetype* archetype, ArchetypeEntity entity);
+        // Fill the row with the archetype's last entity, destroying whatever is still in it first if asked to.
+        void freeRow(const Location& location, bool destroyComponents);
+
+        std::vector<std::unique_ptr<Archetype>> m_archetypes;
+        // Indexed by getTypeID.
+        std::vector<TypeInfo> m_typeInfos;
+
+        // Indexed by entity.
+        std::vector<Location> m_locations;
+        std::vector<ArchetypeEntity> m_freeEntities;
+
+    };
+
+}
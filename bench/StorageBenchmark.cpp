@@ -0,0 +1,103 @@
+#include <chrono>
+
+#include "ArchetypeStorage.h"
+#include "Game.h"
+#include "Graphics/Mesh.h"
+#include "Scene/Components.h"
+#include "Scene/Object.h"
+
+// Compares iterating every mesh and transform through the scene's BOO registry with the chunked ArchetypeStorage. The
+// game only uses BOO, so this is its own executable, built with -DECOSORT_BENCHMARKS=ON.
+
+namespace EcoSort {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        double millisecondsSince(Clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        // Iterating every mesh and transform, which is what recording a frame does, through BOO and the archetype
+        // storage.
+        void benchmarkStorage(unsigned int entities) {
+            // Copies share the one vertex array, so none of this touches OpenGL.
+            Mesh mesh;
+
+            // Every fourth entity is rubbish as well, so the archetype storage has to go through two archetypes.
+            Scene scene;
+            ArchetypeStorage storage;
+            for (unsigned int i = 0; i < entities; i++) {
+                Object object = scene.createObject();
+                object.addComponent<TransformComponent>()->position.y = static_cast<float>(i);
+                object.setComponent(mesh);
+
+                ArchetypeEntity entity = storage.createEntity();
+                storage.addComponent<TransformComponent>(entity).position.y = static_cast<float>(i);
+                storage.addComponent<Mesh>(entity, mesh);
+
+                if (i % 4 == 0) {
+                    object.addComponent<RubbishComponent>();
+                    storage.addComponent<RubbishComponent>(entity);
+                }
+            }
+
+            constexpr unsigned int ITERATIONS = 20;
+            volatile float sink = 0.0f;
+
+            auto visit = [](const Mesh& mesh, const TransformComponent& transform) {
+                return transform.position.y + (mesh.getPrimaryTexture() ? 1.0f : 0.0f);
+            };
+
+            Clock::time_point start = Clock::now();
+            for (unsigned int i = 0; i < ITERATIONS; i++) {
+                float sum = 0.0f;
+                for (auto& [ mesh, transform ] : scene.findAll<Mesh, TransformComponent>()) {
+                    sum += visit(*mesh, *transform);
+                }
+                sink = sink + sum;
+            }
+            double findAllTime = millisecondsSince(start) / ITERATIONS;
+
+            auto& view = scene.view<Mesh, TransformComponent>();
+            start = Clock::now();
+            for (unsigned int i = 0; i < ITERATIONS; i++) {
+                float sum = 0.0f;
+                for (auto& [ mesh, transform ] : view) sum += visit(*mesh, *transform);
+                sink = sink + sum;
+            }
+            double viewTime = millisecondsSince(start) / ITERATIONS;
+
+            start = Clock::now();
+            for (unsigned int i = 0; i < ITERATIONS; i++) {
+                float sum = 0.0f;
+                storage.forEach<Mesh, TransformComponent>([&](Mesh& mesh, TransformComponent& transform) {
+                    sum += visit(mesh, transform);
+                });
+                sink = sink + sum;
+            }
+            double archetypeTime = millisecondsSince(start) / ITERATIONS;
+
+            auto throughput = [&](double milliseconds) {
+                return milliseconds > 0.0 ? entities / milliseconds / 1000.0 : 0.0;
+            };
+            LOGGER.info("{} meshes: BOO findAll {:.3f}ms ({:.1f}M/s), BOO view {:.3f}ms ({:.1f}M/s), "
+                "archetypes {:.3f}ms ({:.1f}M/s) in {} chunks", entities, findAllTime, throughput(findAllTime), viewTime,
+                throughput(viewTime), archetypeTime, throughput(archetypeTime), storage.getChunkCount());
+        }
+    }
+
+}
+
+int main() {
+
+    // Only for its logger, since nothing is rendered.
+    EcoSort::Game game;
+
+    EcoSort::Game::setInstance(&game);
+
+    for (unsigned int entities : { 10000u, 100000u }) EcoSort::benchmarkStorage(entities);
+
+    return 0;
+}
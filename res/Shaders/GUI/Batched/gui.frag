@@ -0,0 +1,13 @@
+#version 410 core
+
+in vec2 v_uv;
+in vec4 v_colour;
+
+layout(location = 0) out vec4 o_colour;
+
+// Usually the GUI atlas, with plain colours drawn from its white region.
+uniform sampler2D u_image;
+
+void main() {
+    o_colour = texture(u_image, v_uv) * v_colour;
+}
@@ -0,0 +1,20 @@
+#version 410 core
+
+// Batched GUI quads. Vertices are already in screen space, with each quad's uvs and colour written into every one of
+// its vertices, so a whole batch needs nothing but the projection.
+
+layout(location = 0) in vec3 a_position;
+layout(location = 1) in vec2 a_uv;
+layout(location = 2) in vec4 a_colour;
+
+uniform mat4 u_projection;
+
+out vec2 v_uv;
+out vec4 v_colour;
+
+void main() {
+    v_uv = a_uv;
+    v_colour = a_colour;
+
+    gl_Position = u_projection * vec4(a_position, 1.0);
+}
@@ -0,0 +1,6 @@
+#version 410 core
+
+// Depth pre-pass. Colour writes are masked off, so nothing but the depth buffer is written and the fragment shader
+// has nothing to do.
+
+void main() {}
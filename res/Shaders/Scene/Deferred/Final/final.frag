@@ -0,0 +1,11 @@
+#version 410 core
+
+// Render targets are allocated larger than the area drawn to, so this reads by texel rather than by uv.
+
+uniform sampler2D u_screen;
+
+layout(location = 0) out vec4 o_colour;
+
+void main() {
+    o_colour = texelFetch(u_screen, ivec2(gl_FragCoord.xy), 0);
+}
@@ -0,0 +1,43 @@
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : require
+
+// Geometry pass for multi-draw indirect. Every draw in a batch shares the same uniforms, so each one finds its own
+// matrices in a buffer at the index it was given as its base instance. Otherwise it does what Deferred/gbuffer.vert
+// does, with the same outputs, so the geometry pass shares Deferred/gbuffer.frag and fills the G-buffer the same way
+// on either path.
+
+layout(location = 0) in vec3 a_position;
+layout(location = 1) in vec3 a_normal;
+layout(location = 2) in vec2 a_uv;
+
+struct Draw {
+    mat4 model;
+    // A mat3 padded out to four columns.
+    mat4 normalMatrix;
+};
+
+layout(std430, binding = 0) readonly buffer Draws {
+    Draw u_draws[];
+};
+
+uniform mat4 u_projection;
+uniform mat4 u_view;
+
+out vec3 v_position;
+out vec3 v_normal;
+out vec2 v_uv;
+
+// Also used by the depth pre-pass, whose depth should match this pass's exactly.
+invariant gl_Position;
+
+void main() {
+    Draw draw = u_draws[gl_BaseInstanceARB];
+
+    vec4 position = draw.model * vec4(a_position, 1.0);
+
+    v_position = position.xyz;
+    v_normal = mat3(draw.normalMatrix) * a_normal;
+    v_uv = a_uv;
+
+    gl_Position = u_projection * u_view * position;
+}
@@ -0,0 +1,46 @@
+// Light definitions and shading functions shared by every lighting permutation.
+//
+// These replace the shading of the single lighting shader the permutations were split from. Lights are Lambertian,
+// fading smoothly to nothing at their distance, spot lights add a soft edged cone around their direction, and ambient
+// light is a tenth of the albedo.
+
+struct Light {
+    vec3 position;
+    vec3 direction;
+    vec3 colour;
+    float distance;
+};
+
+#define AMBIENT_STRENGTH 0.1
+
+// Cosines of the angles where a spot light starts to fade and where it reaches zero.
+#define SPOT_INNER_COS 0.95
+#define SPOT_OUTER_COS 0.85
+
+// Smooth falloff that reaches zero at the light's distance.
+float getAttenuation(float lightDistance, float range) {
+    float falloff = clamp(1.0 - lightDistance / range, 0.0, 1.0);
+    return falloff * falloff;
+}
+
+vec3 shadeDirectional(Light light, vec3 normal, vec3 albedo) {
+    float diffuse = max(dot(normal, -normalize(light.direction)), 0.0);
+    return albedo * light.colour * diffuse;
+}
+
+vec3 shadePoint(Light light, vec3 position, vec3 normal, vec3 albedo) {
+    vec3 toLight = light.position - position;
+    float lightDistance = length(toLight);
+    float diffuse = max(dot(normal, toLight / lightDistance), 0.0);
+    return albedo * light.colour * diffuse * getAttenuation(lightDistance, light.distance);
+}
+
+vec3 shadeSpot(Light light, vec3 position, vec3 normal, vec3 albedo) {
+    vec3 toLight = light.position - position;
+    float lightDistance = length(toLight);
+    vec3 lightDir = toLight / lightDistance;
+
+    float cone = smoothstep(SPOT_OUTER_COS, SPOT_INNER_COS, dot(-lightDir, normalize(light.direction)));
+    float diffuse = max(dot(normal, lightDir), 0.0);
+    return albedo * light.colour * diffuse * cone * getAttenuation(lightDistance, light.distance);
+}
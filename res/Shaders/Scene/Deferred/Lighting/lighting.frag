@@ -0,0 +1,51 @@
+#version 410 core
+
+// One permutation of this shader is built per light type, selected by defining exactly one of LIGHT_AMBIENT,
+// LIGHT_POINT, LIGHT_SPOT or LIGHT_DIRECTIONAL, so there is no branching on the light type per pixel.
+
+#include "light.glsl"
+
+layout(location = 0) out vec4 o_colour;
+
+uniform sampler2D u_gPositions;
+uniform sampler2D u_gNormals;
+uniform sampler2D u_gAlbedos;
+
+uniform Light u_light;
+
+// Lighting can be computed at a fraction of the G-buffer's resolution, in which case each pixel is shaded with the
+// G-buffer texel in the middle of the block of pixels it covers.
+uniform int u_lightingScale;
+
+void main() {
+    ivec2 texel = ivec2(gl_FragCoord.xy) * u_lightingScale + u_lightingScale / 2;
+
+    vec4 albedo = texelFetch(u_gAlbedos, texel, 0);
+
+    // Nothing was drawn to this pixel in the geometry pass.
+    if (albedo.a == 0.0) discard;
+
+#if defined(LIGHT_AMBIENT)
+
+    // The ambient pass is drawn once before the lights and is the only one that writes alpha.
+    o_colour = vec4(albedo.rgb * AMBIENT_STRENGTH, albedo.a);
+
+#else
+
+    vec3 position = texelFetch(u_gPositions, texel, 0).xyz;
+    vec3 normal = normalize(texelFetch(u_gNormals, texel, 0).xyz);
+
+#if defined(LIGHT_POINT)
+    vec3 colour = shadePoint(u_light, position, normal, albedo.rgb);
+#elif defined(LIGHT_SPOT)
+    vec3 colour = shadeSpot(u_light, position, normal, albedo.rgb);
+#elif defined(LIGHT_DIRECTIONAL)
+    vec3 colour = shadeDirectional(u_light, normal, albedo.rgb);
+#else
+#error "No light type defined"
+#endif
+
+    o_colour = vec4(colour, 0.0);
+
+#endif
+}
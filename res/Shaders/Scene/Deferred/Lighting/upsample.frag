@@ -0,0 +1,75 @@
+#version 410 core
+
+// Brings lighting computed at a fraction of the resolution back up to full resolution. Each pixel blends the four
+// nearest reduced samples with bilinear weights, scaled down by how far the depth and normal each sample was shaded
+// with are from the pixel's own, so light doesn't bleed across the edges of objects.
+
+layout(location = 0) out vec4 o_colour;
+
+uniform sampler2D u_gNormals;
+uniform sampler2D u_gDepth;
+uniform sampler2D u_lighting;
+
+uniform int u_lightingScale;
+// The size of the region drawn to in u_lighting and in the G-buffer, which are both larger than that.
+uniform ivec2 u_lightingSize;
+uniform ivec2 u_size;
+
+// The clip planes of the projection the geometry pass used.
+uniform float u_near;
+uniform float u_far;
+
+#define DEPTH_EPSILON 0.01
+#define NORMAL_POWER 16.0
+
+float getLinearDepth(float depth) {
+    return u_near * u_far / (u_far - depth * (u_far - u_near));
+}
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+
+    float depth = texelFetch(u_gDepth, pixel, 0).r;
+    // Nothing was drawn to this pixel in the geometry pass.
+    if (depth == 1.0) discard;
+
+    float linearDepth = getLinearDepth(depth);
+    vec3 normal = normalize(texelFetch(u_gNormals, pixel, 0).xyz);
+
+    // Reduced sample i was shaded from the texel at i * scale + scale / 2, so this is where the pixel falls between
+    // the samples around it.
+    vec2 position = (vec2(pixel) - float(u_lightingScale / 2)) / float(u_lightingScale);
+    ivec2 base = ivec2(floor(position));
+    vec2 fraction = position - vec2(base);
+
+    vec3 total = vec3(0.0);
+    float totalWeight = 0.0;
+
+    for (int y = 0; y < 2; y++) {
+        for (int x = 0; x < 2; x++) {
+            ivec2 reduced = clamp(base + ivec2(x, y), ivec2(0), u_lightingSize - 1);
+            ivec2 source = min(reduced * u_lightingScale + u_lightingScale / 2, u_size - 1);
+
+            float bilinear = (x == 0 ? 1.0 - fraction.x : fraction.x) * (y == 0 ? 1.0 - fraction.y : fraction.y);
+
+            float sampleDepth = getLinearDepth(texelFetch(u_gDepth, source, 0).r);
+            float depthWeight = 1.0 / (DEPTH_EPSILON + abs(sampleDepth - linearDepth) / linearDepth);
+
+            vec3 sampleNormal = normalize(texelFetch(u_gNormals, source, 0).xyz);
+            float normalWeight = pow(max(dot(sampleNormal, normal), 0.0), NORMAL_POWER);
+
+            float weight = bilinear * depthWeight * normalWeight;
+            total += texelFetch(u_lighting, reduced, 0).rgb * weight;
+            totalWeight += weight;
+        }
+    }
+
+    // Thin details can be missed by every sample around them, in which case the nearest sample is the best there is.
+    if (totalWeight < 1e-4) {
+        ivec2 nearest = clamp(ivec2(round(position)), ivec2(0), u_lightingSize - 1);
+        total = texelFetch(u_lighting, nearest, 0).rgb;
+        totalWeight = 1.0;
+    }
+
+    o_colour = vec4(total / totalWeight, 1.0);
+}
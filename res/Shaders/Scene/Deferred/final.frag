@@ -1,3 +0,0 @@
-version https://git-lfs.github.com/spec/v1
-oid sha256:7517c1e7f1f8ca6c133b6c50810264bcdebe8d57039f520d936e387e2b5afd37
-size 140
@@ -1,3 +0,0 @@
-version https://git-lfs.github.com/spec/v1
-oid sha256:b5782b9b2f880ce6aa827999d56ee5694122a427627650236730e1321d1989da
-size 1871
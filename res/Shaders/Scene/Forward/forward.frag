@@ -0,0 +1,60 @@
+#version 410 core
+
+// Forward+ shading. Each fragment is lit by every directional light and by the lights in its screen tile's list, in a
+// single pass with no G-buffer. The depth pre-pass has already run, so only visible fragments get here.
+
+#include "../Deferred/Lighting/light.glsl"
+
+// Same values as LightComponent::LightType.
+#define LIGHT_TYPE_SPOT 1
+
+in vec3 v_position;
+in vec3 v_normal;
+in vec2 v_uv;
+
+layout(location = 0) out vec4 o_colour;
+
+uniform sampler2D u_primaryTexture;
+
+// Three texels per light: position and distance, direction and type, then colour. Directional lights come first.
+uniform samplerBuffer u_lights;
+// An offset and a count for each tile, followed by the light indices the offsets point into.
+uniform usamplerBuffer u_tiles;
+
+uniform int u_tileSize;
+uniform int u_tilesX;
+uniform int u_directionalLights;
+
+Light fetchLight(int index, out int type) {
+    vec4 position = texelFetch(u_lights, index * 3);
+    vec4 direction = texelFetch(u_lights, index * 3 + 1);
+    vec4 colour = texelFetch(u_lights, index * 3 + 2);
+
+    type = int(direction.w);
+    return Light(position.xyz, direction.xyz, colour.rgb, position.w);
+}
+
+void main() {
+    vec3 albedo = texture(u_primaryTexture, v_uv).rgb;
+    vec3 normal = normalize(v_normal);
+    int type;
+
+    vec3 colour = albedo * AMBIENT_STRENGTH;
+
+    for (int i = 0; i < u_directionalLights; i++) {
+        colour += shadeDirectional(fetchLight(i, type), normal, albedo);
+    }
+
+    ivec2 tile = ivec2(gl_FragCoord.xy) / u_tileSize;
+    int tileIndex = tile.y * u_tilesX + tile.x;
+    int offset = int(texelFetch(u_tiles, tileIndex * 2).r);
+    int count = int(texelFetch(u_tiles, tileIndex * 2 + 1).r);
+
+    for (int i = 0; i < count; i++) {
+        Light light = fetchLight(int(texelFetch(u_tiles, offset + i).r), type);
+        colour += type == LIGHT_TYPE_SPOT ? shadeSpot(light, v_position, normal, albedo)
+                                          : shadePoint(light, v_position, normal, albedo);
+    }
+
+    o_colour = vec4(colour, 1.0);
+}
@@ -0,0 +1,29 @@
+#version 410 core
+
+// Forward+ vertex shader for meshes drawn one at a time. The depth pre-pass is drawn with this too, so both passes
+// compute exactly the same depth for GL_EQUAL to match against.
+
+layout(location = 0) in vec3 a_position;
+layout(location = 1) in vec3 a_normal;
+layout(location = 2) in vec2 a_uv;
+
+uniform mat4 u_projection;
+uniform mat4 u_view;
+uniform mat4 u_model;
+uniform mat3 u_normalMatrix;
+
+out vec3 v_position;
+out vec3 v_normal;
+out vec2 v_uv;
+
+invariant gl_Position;
+
+void main() {
+    vec4 position = u_model * vec4(a_position, 1.0);
+
+    v_position = position.xyz;
+    v_normal = u_normalMatrix * a_normal;
+    v_uv = a_uv;
+
+    gl_Position = u_projection * u_view * position;
+}
@@ -59,10 +59,9 @@ namespace EcoSort {
         const tinyobj::attrib_t& attribs = reader.GetAttrib();
         const tinyobj::shape_t& shape = reader.GetShapes()[0]; // TODO: multiple shapes
 
+        // Interleaved as position, normal, uv, which is the layout of the mesh heap.
         std::vector<float> vertices;
         std::vector<unsigned int> indices;
-        std::vector<float> normals;
-        std::vector<float> uvs;
 
         std::unordered_map<Vertex, unsigned int> uniqueVertices;
 
@@ -88,22 +87,22 @@ namespace EcoSort {
 
             // Append the normal to the buffer
             if (index.normal_index >= 0) {
-                normals.push_back(attribs.normals[3 * index.normal_index + 0]);
-                normals.push_back(attribs.normals[3 * index.normal_index + 1]);
-                normals.push_back(attribs.normals[3 * index.normal_index + 2]);
+                vertices.push_back(attribs.normals[3 * index.normal_index + 0]);
+                vertices.push_back(attribs.normals[3 * index.normal_index + 1]);
+                vertices.push_back(attribs.normals[3 * index.normal_index + 2]);
             } else {
-                normals.push_back(0.0f);
-                normals.push_back(0.0f);
-                normals.push_back(0.0f);
+                vertices.push_back(0.0f);
+                vertices.push_back(0.0f);
+                vertices.push_back(0.0f);
             }
 
             // Append the UV coordinates to the buffer, or 0.0f if no UVs are present.
             if (index.texcoord_index >= 0) {
-                uvs.push_back(attribs.texcoords[2 * index.texcoord_index + 0]);
-                uvs.push_back(attribs.texcoords[2 * index.texcoord_index + 1]);
+                vertices.push_back(attribs.texcoords[2 * index.texcoord_index + 0]);
+                vertices.push_back(attribs.texcoords[2 * index.texcoord_index + 1]);
             } else {
-                uvs.push_back(0.0f);
-                uvs.push_back(0.0f);
+                vertices.push_back(0.0f);
+                vertices.push_back(0.0f);
             }
 
             // If the vertex is unique, append indices with the index of this vertex, which is the number of unique
@@ -112,21 +111,26 @@ namespace EcoSort {
             uniqueVertices[vertex] = indices.back();
         }
 
-        mesh->setVertices(vertices.data(), vertices.size() / 3);
-        mesh->setIndices(indices.data(), indices.size());
-        mesh->setBuffer(1,
-            normals.data(),
-            normals.size() * sizeof(float),
-            DataType::FLOAT,
-            DataElements::THREE);
-
-        mesh->setBuffer(2,
-            uvs.data(),
-            uvs.size() * sizeof(float),
-            DataType::FLOAT,
-            DataElements::TWO);
+        mesh->setAllocation(getMeshHeap().allocate(vertices.data(), static_cast<unsigned int>(uniqueVertices.size()),
+            indices.data(), static_cast<unsigned int>(indices.size())));
 
         return mesh;
     }
 
+    MeshHeap& AssetFetcher::getMeshHeap() {
+        // 64k vertices is 2MB of vertex data, which covers every model in the game several times over.
+        static MeshHeap heap({
+            { 0, DataType::FLOAT, DataElements::THREE }, // Position
+            { 1, DataType::FLOAT, DataElements::THREE }, // Normal
+            { 2, DataType::FLOAT, DataElements::TWO }    // UV
+        }, 65536, 196608);
+        return heap;
+    }
+
+    TextureAtlas& AssetFetcher::getGUIAtlas() {
+        // Enough for the menu buttons many times over, and a font or two.
+        static TextureAtlas atlas(1024, 1024);
+        return atlas;
+    }
+
 }
@@ -3,13 +3,23 @@
 #include <memory>
 
 #include "Graphics/Mesh.h"
+#include "Graphics/MeshHeap.h"
+#include "Graphics/TextureAtlas.h"
 
 namespace EcoSort {
 
     class AssetFetcher {
     public:
         
+        // The mesh is placed in the mesh heap rather than given buffers of its own.
         static std::shared_ptr<Mesh> meshFromPath(const char* path);
+
+        // Holds every mesh loaded from a file.
+        static MeshHeap& getMeshHeap();
+
+        // Holds the GUI's images, so the whole GUI can be drawn from one texture. Created on first use, which must be
+        // on a thread with a current context.
+        static TextureAtlas& getGUIAtlas();
         
     };
     
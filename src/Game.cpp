@@ -3,12 +3,18 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <GLFW/glfw3.h>
 #include "AssetFetcher.h"
+#include "Graphics/GLFeatures.h"
+#include "Graphics/GLState.h"
+#include "Graphics/RenderStats.h"
 #include <../demo/Clock.h>
 #include "Interface/Window.h"
 #include "Scene/Components.h"
 #include "Scene/Object.h"
 #include <dynamics/q3Contact.h>
 
+#include <algorithm>
+#include <optional>
+
 namespace EcoSort {
     Game *Game::s_instance = nullptr;
 
@@ -50,8 +56,7 @@ namespace EcoSort {
         // Add rubbish to a list in a conveyor so its velocity can be set every frame.
         if (conveyorObject && rubbishObject) {
             auto conveyorComp = conveyorObject->getComponent<ConveyorComponent>();
-            auto rubbishBody = rubbishObject->getComponent<RigidBodyComponent>();
-            conveyorComp->touchingRubbish.emplace_back(rubbishBody);
+            conveyorComp->touchingRubbish.insert(rubbishObject->getComponentHandle<RigidBodyComponent>());
         }
 
         // Increase the players score if they got the rubbish in the correct collector and move boxes into a unique spot
@@ -97,57 +102,58 @@ namespace EcoSort {
 
         if (conveyorObject && rubbishObject) {
             auto conveyorComp = conveyorObject->getComponent<ConveyorComponent>();
-            auto rubbishBody = rubbishObject->getComponent<RigidBodyComponent>();
-            // I can't think of a way to implement an equals operator for a ComponentRef (i the BOO library) so I use
-            // std::erase_if with my own lambda predicate that compares the memory addresses of the two components.
-            std::erase_if(
-                conveyorComp->touchingRubbish,
-                [&rubbishBody](BOO::ComponentRef<RigidBodyComponent>& other) -> bool {
-                    return other.valid() && rubbishBody.get() == other.get();
-                }
-            );
+            conveyorComp->touchingRubbish.erase(rubbishObject->getComponentHandle<RigidBodyComponent>());
         }
         
     }
 
-    Object spawnRubbish(Scene& scene, glm::vec3 position) {
-        Object rubbish = scene.createObject();
-        auto transform = rubbish.addComponent<TransformComponent>();
-        auto mesh = rubbish.addComponent<Mesh>();
-        auto rigidBody = rubbish.addComponent<RigidBodyComponent>();
-        auto rubbishComp = rubbish.addComponent<RubbishComponent>();
-        transform->position = position;
-        transform->scale = glm::vec3(5.0f);
-        rubbish.setComponent(*AssetFetcher::meshFromPath("res/Models/Cube.obj"));
-        mesh->setPrimaryTexture("res/Textures/white.png");
-        rigidBody->bodyType = eDynamicBody;
-        rigidBody->scale = { 10.0f, 10.0f, 10.0f };
-
-        rubbishComp->type = static_cast<RubbishComponent::RubbishType>(q3RandomInt(0, 2));
-        switch (rubbishComp->type) {
+    // The rubbish is made through the scene's command buffer, so it only appears at the next flush and can be spawned
+    // while the scene is being iterated. Its mesh and textures are loaded straight away though, so this still has to
+    // be called on the thread with the context.
+    void spawnRubbish(Scene& scene, glm::vec3 position, const q3Vec3& angularVelocity) {
+        TransformComponent transform;
+        transform.position = position;
+        transform.scale = glm::vec3(5.0f);
+
+        Mesh mesh = *AssetFetcher::meshFromPath("res/Models/Cube.obj");
+        mesh.setPrimaryTexture("res/Textures/white.png");
+
+        RigidBodyComponent rigidBody;
+        rigidBody.bodyType = eDynamicBody;
+        rigidBody.scale = { 10.0f, 10.0f, 10.0f };
+        rigidBody.initialAngularVelocity = angularVelocity;
+
+        RubbishComponent rubbishComp;
+        rubbishComp.type = static_cast<RubbishComponent::RubbishType>(q3RandomInt(0, 2));
+        switch (rubbishComp.type) {
             case RubbishComponent::RubbishType::RUBBISH: {
                 auto texturePath = std::format("res/Textures/rubbish{}.png", q3RandomInt(0, 2));
-                mesh->setPrimaryTexture(texturePath.c_str());
+                mesh.setPrimaryTexture(texturePath.c_str());
                 break;
             }
             case RubbishComponent::RubbishType::RECYCLING: {
                 auto texturePath = std::format("res/Textures/recycling{}.png", q3RandomInt(0, 2));
-                mesh->setPrimaryTexture(texturePath.c_str());
+                mesh.setPrimaryTexture(texturePath.c_str());
                 break;
             }
             case RubbishComponent::RubbishType::FOOD: {
                 auto texturePath = std::format("res/Textures/food{}.png", q3RandomInt(0, 2));
-                mesh->setPrimaryTexture(texturePath.c_str());
+                mesh.setPrimaryTexture(texturePath.c_str());
                 break;
             }
             default:
                 LOGGER.warn("Invalid rubbish type");
         }
-        
-        return rubbish;
+
+        SceneCommandBuffer& commands = scene.getCommands();
+        DeferredEntity rubbish = commands.createObject();
+        commands.addComponent(rubbish, transform);
+        commands.addComponent(rubbish, std::move(mesh));
+        commands.addComponent(rubbish, rigidBody);
+        commands.addComponent(rubbish, rubbishComp);
     }
 
-    void Game::run() {
+    void Game::run(const GameOptions& options) {
         m_logger.info("Initialising game");
 
         // If GLFW has an error, it will call this function where I log the error.
@@ -157,7 +163,10 @@ namespace EcoSort {
 
         // Initialise GLFW so a window can be created.
         result = glfwInit();
-        m_logger.strongAssert(result, "Failed to initialize GLFW");
+        // Headless mode still creates a (hidden) window, so this fails the same way without a display.
+        m_logger.strongAssert(result, options.headless
+            ? "Failed to initialize GLFW, headless mode still needs a display such as Xvfb"
+            : "Failed to initialize GLFW");
         m_logger.debug("Initialised GLFW");
 
         // Specify the version of OpenGL that will be used as a window hint. The window hints will apply to all windows
@@ -167,14 +176,25 @@ namespace EcoSort {
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+        // Drivers give back the newest version compatible with what was asked for, so newer features are still
+        // looked for once the window exists, unless they have been turned off.
+        if (options.forceGL41) GLFeatures::disable();
+
         // Create a new scope so the window will be destroyed once the main loop has finished.
         {
+            // Window can't be moved since GLFW holds a pointer to it, so it is constructed in place.
+            std::optional<Window> windowStorage;
+            if (options.headless) {
+                windowStorage.emplace("EcoSort", options.width, options.height, true);
+            } else {
 #ifdef RG_DEBUG
-            Window window("EcoSort", 750, 750);
+                windowStorage.emplace("EcoSort", 750, 750);
 #else
-            Window window("EcoSort");
+                windowStorage.emplace("EcoSort");
 #endif
-            m_logger.info("Initialised window");
+            }
+            Window& window = *windowStorage;
+            m_logger.info("Initialised {}window", options.headless ? "headless " : "");
 
             // Game extends q3ContactListener so this can be used since that was the most convenient way I could
             // implement collision detection with this library and not making 800 new files. Game::BeginContact will be
@@ -244,8 +264,7 @@ namespace EcoSort {
                 { 0, 0 },
                 { 1, 0.2 }
             };
-            playButton.image = std::make_shared<Texture>();
-            playButton.image->setData("res/UI/Play.png");
+            playButton.setImage(AssetFetcher::getGUIAtlas().add("res/UI/Play.png"));
             
             auto& [ quitButton, quitButtonTransform ] =
                 *menuListComp->guis.emplace_back(
@@ -259,8 +278,11 @@ namespace EcoSort {
                 { 0, 0 },
                 { 1, 0.2 }
             };
-            quitButton.image = std::make_shared<Texture>();
-            quitButton.image->setData("res/UI/Quit.png");
+            quitButton.setImage(AssetFetcher::getGUIAtlas().add("res/UI/Quit.png"));
+
+            // The buttons are checked every frame, including after the menu scene has been replaced by the game scene,
+            // so they are kept alive independently of the scene.
+            auto menuGuis = menuListComp->guis;
 
             m_logger.info("Setting up game scene");
 
@@ -365,17 +387,39 @@ namespace EcoSort {
                 }
             }
 
-            double startTime = glfwGetTime();
+            if (options.startInGame) m_activeScene = m_gameScene;
+
             int frames = 0;
+
+            FramePacer& framePacer = window.getFramePacer();
+            framePacer.configure(options.presentMode, options.targetFrameRate, options.maxFramesInFlight);
+
+            double runStartTime = glfwGetTime();
+            unsigned int totalFrames = 0;
             
             Clock physicsClock;
 
+            FrameCapture& frameCapture = window.getRenderer()->getFrameCapture();
+            if (!options.captureDirectory.empty()) frameCapture.start(options.captureDirectory, options.captureFrames);
+
+            window.getRenderer()->setLightingScale(options.lightingScale);
+            window.getRenderer()->setDepthPrePassMode(options.depthPrePass);
+            window.getRenderer()->setRenderPath(options.renderPath);
+            bool lightingKeyWasDown = false;
+
+            if (options.pipelined) {
+                window.startRenderThread();
+                m_logger.info("Rendering on a separate thread");
+            }
+
             // While the window is open, i.e. the operating system has not requested for it to be closed and before the
             // last box has been consumed by a collector.
             while (window.isOpen() && totalBoxes > consumedBoxes) {
 
-                double dt = glfwGetTime() - startTime;
-                startTime = glfwGetTime();
+                // Waits here if the frame rate is limited. A fixed timestep makes runs deterministic for benchmarking,
+                // regardless of how long frames take.
+                double frameTime = framePacer.beginFrame();
+                double dt = options.fixedTimestep > 0.0 ? options.fixedTimestep : frameTime;
 
                 // Poll events in GLFW, which will handle OS events and user interfaces, such as the keyboard and mouse.
                 glfwPollEvents();
@@ -387,41 +431,28 @@ namespace EcoSort {
 
                 Interface& interface = window.getInterface();
 
+                // F2 cycles the lighting resolution between full, half and quarter, to compare quality and cost.
+                bool lightingKeyDown = interface.getKeyEnabledState(Key::F2);
+                if (lightingKeyDown && !lightingKeyWasDown) {
+                    Renderer* renderer = window.getRenderer();
+                    renderer->setLightingScale(renderer->getLightingScale() == 4 ? 1 : renderer->getLightingScale() * 2);
+                    m_logger.info("Lighting at 1/{} resolution", renderer->getLightingScale());
+                }
+                lightingKeyWasDown = lightingKeyDown;
+
                 auto mouseX = interface.getMouseX();
                 auto mouseY = interface.getMouseY();
                 auto mouseEnabled = interface.getMouseButtonEnabledState(MouseButton::LEFT);
 
-                // Several queries are also made in the game loop. Queries are made with a variant of the Scene::find...
-                // methods. The variants have different requirements for the components that are present in an entity
-                // for it to be returned in the query. The 'All' variant is used exclusively in this project, and it
-                // that an entity contains at least all the components specified in order to be returned.
-                // BOO::QueryResult is a wrapper type of vector of tuples of the types specified in the query.
-                // It defines begin and end methods, which return iterators, so it can be iterated and tuples can be
-                // expressed as structured bindings which makes code very readable and clean.
-                for (auto& [ guiFrame, frameTransform ] : m_activeScene.findAll<GUIFrameComponent, Transform2DComponent>()) {
-
-                    TransformComponent absoluteFrameTransform = window.getRenderer()->getAbsoluteTransform2D(*frameTransform);
-
-                    for (auto& guiptr : guiFrame->guis) {
-
-                        auto& [ gui, transform ] = *guiptr;
-
-                        TransformComponent absoluteTransform = Renderer::getRelativeTransform2D(transform, absoluteFrameTransform);
-
-                        gui.isHovered = mouseX >= absoluteTransform.position.x - (absoluteTransform.scale.x / 2) &&
-                            mouseX <= absoluteTransform.position.x + (absoluteTransform.scale.x / 2) &&
-                            mouseY >= absoluteTransform.position.y - (absoluteTransform.scale.y / 2) &&
-                            mouseY <= absoluteTransform.position.y + (absoluteTransform.scale.y / 2);
-
-                        gui.isClicked = mouseEnabled && gui.isHovered;
-                        
-                    }
-                }
+                // The layout only changes when a GUI or the window does, and hit testing only looks at the GUIs near
+                // the mouse, so this costs next to nothing for a menu that is sitting still.
+                window.getRenderer()->layoutGUI(m_activeScene).updateHover(static_cast<float>(mouseX),
+                    static_cast<float>(mouseY), mouseEnabled);
 
                 // physics
 
                 // This initialises and updates bodies in the physics scene.
-                for (auto& [ rigidBody, transform ] : m_activeScene.findAll<RigidBodyComponent, TransformComponent>()) {
+                for (auto& [ rigidBody, transform ] : m_activeScene.view<RigidBodyComponent, TransformComponent>()) {
                     
                     auto rotAxis = glm::axis(transform->rotation);
                     q3Vec3 q3RotationAxis = { rotAxis.x, rotAxis.y, rotAxis.z };
@@ -459,6 +490,7 @@ namespace EcoSort {
                 }
 
                 float time = physicsClock.Start();
+                if (options.fixedTimestep > 0.0) time = static_cast<float>(options.fixedTimestep);
 
                 // Arbitrary number of iterations that was picked after I closed my eyes and pressed my keyboard. This
                 // has no meaning or thought behind it.
@@ -475,7 +507,7 @@ namespace EcoSort {
                 physicsClock.Stop();
 
                 // This will synchronise all the transforms with the physics bodies.
-                for (auto& [ rigidBody, transform ] : m_activeScene.findAll<RigidBodyComponent, TransformComponent>()) {
+                for (auto& [ rigidBody, transform ] : m_activeScene.view<RigidBodyComponent, TransformComponent>()) {
 
                     auto& newTransform = rigidBody->body->GetTransform();
                     glm::mat3 rotation = {
@@ -492,19 +524,24 @@ namespace EcoSort {
                 // game updating
 
                 // This moves all the rubbish touching a conveyor in the forward direction of the conveyor
-                for (auto& [ conveyor, conveyorTransform ] : m_activeScene.findAll<ConveyorComponent, TransformComponent>()) {
+                for (auto& [ conveyor, conveyorTransform ] : m_activeScene.view<ConveyorComponent, TransformComponent>()) {
                     
                     auto rotationMatrix = glm::mat3_cast(conveyorTransform->rotation);
                     auto conveyorDirection = rotationMatrix * glm::vec3(0.0f, 0.0f, 1.0f);
 
-                    for (auto& rubbishBody : conveyor->touchingRubbish) {
-                        if (!rubbishBody.valid()) continue;
+                    // Removed rubbish never gets an EndContact, so its handles are dropped here once they go stale.
+                    std::erase_if(conveyor->touchingRubbish, [this](const ComponentHandle<RigidBodyComponent>& handle) {
+                        return !m_activeScene.isValid(handle.entity);
+                    });
+                    for (auto& rubbishHandle : conveyor->touchingRubbish) {
+                        RigidBodyComponent* rubbishBody = m_activeScene.getComponent(rubbishHandle);
+                        if (!rubbishBody || !rubbishBody->body) continue;
                         rubbishBody->body->SetLinearVelocity({ conveyorDirection.x * 10, 0, conveyorDirection.z * 10 });
                     }
                 }
 
                 // This moves the pushers across the conveyors
-                for (auto& [ pusher, pusherTransform, pusherRigidBody ] : m_gameScene.findAll<PusherComponent, TransformComponent, RigidBodyComponent>()) {
+                for (auto& [ pusher, pusherTransform, pusherRigidBody ] : m_gameScene.view<PusherComponent, TransformComponent, RigidBodyComponent>()) {
                     // Intended narrowing conversion since the progress will be 0 when the pusher is not active.
                     if (!pusher->progress && !interface.getKeyEnabledState(pusher->activationKey)) continue;
                     pusher->progress += dt;
@@ -523,31 +560,39 @@ namespace EcoSort {
                 // an if instead of a while.
                 if (spawnAccumulator >= spawnDelay) {
                     spawnAccumulator -= spawnDelay;
-                    auto isGameQuery = m_activeScene.findAll<IsGameFlagComponent>();
-                    if (isGameQuery.begin() == isGameQuery.end()) {
-                        Object rubbish = spawnRubbish(m_menuScene, glm::vec3(0, 70, q3RandomFloat(-60, 60)));
-                        rubbish.getComponent<RigidBodyComponent>()->initialAngularVelocity = {
+                    if (m_activeScene.view<IsGameFlagComponent>().empty()) {
+                        spawnRubbish(m_menuScene, glm::vec3(0, 70, q3RandomFloat(-60, 60)), {
                             q3RandomFloat(-1.0f, 1.0f),
                             q3RandomFloat(-1.0f, 1.0f),
                             q3RandomFloat(-1.0f, 1.0f)
-                        };
+                        });
                     } else if (totalBoxes > spawnedBoxes) {
                         // Change the spawn delay once the game scene is active since this piece of code is also used
                         // for main menu decoration.
                         spawnDelay = 5.0;
-                        spawnRubbish(m_activeScene, glm::vec3(0.0f, 10.0f, -5 * 11.5f));
+                        spawnRubbish(m_activeScene, glm::vec3(0.0f, 10.0f, -5 * 11.5f), { 0.0f, 0.0f, 0.0f });
                         spawnedBoxes++;
                     }
                 }
 
                 // Delete boxes that have fallen too far, since allocating hundreds of textures with tens of thousands
                 // of pixels uses a considerable amount of memory. If I cached textures that wouldn't be a problem but
-                // that's time I have to spend.
-                for (auto& [ _, transform ] : m_activeScene.findAll<RubbishComponent, TransformComponent>()) {
-                    if (transform->position.y < -200.0f) {
-                        Object object(m_activeScene, transform.getEntity());
-                        m_activeScene.removeObject(object);
-                    }
+                // that's time I have to spend. The removals are deferred, since the view can't change while it is
+                // being iterated.
+                for (auto& [ _, transform ] : m_activeScene.view<RubbishComponent, TransformComponent>()) {
+                    if (transform->position.y < -200.0f) m_activeScene.getCommands().removeObject(transform.getEntity());
+                }
+
+                // Every structural change recorded this frame, from spawning and removing rubbish, is made here in one
+                // go, before the frame is recorded and before the mesh heap looks at what was freed.
+                m_activeScene.flushCommands();
+
+                // Removed rubbish leaves holes in the mesh heap, which are packed together once they make up most of
+                // it. Meshes are moved around, so the render thread has to be done with them first.
+                MeshHeap& meshHeap = AssetFetcher::getMeshHeap();
+                if (meshHeap.shouldDefragment()) {
+                    if (RenderThread* renderThread = window.getRenderThread()) renderThread->waitIdle();
+                    meshHeap.defragment();
                 }
 
                 // qu3e did not appreciate having multiple physics scenes, and since it is a small library it was hard
@@ -555,7 +600,7 @@ namespace EcoSort {
                 if (playButton.isClicked) {
                     m_physicsScene.RemoveAllBodies();
 
-                    for (auto& [ rigidBody, transform ] : m_activeScene.findAll<RigidBodyComponent, TransformComponent>()) {
+                    for (auto& [ rigidBody, transform ] : m_activeScene.view<RigidBodyComponent, TransformComponent>()) {
                         rigidBody->body = nullptr;
                     }
                     
@@ -563,7 +608,7 @@ namespace EcoSort {
                 }
                 if (quitButton.isClicked) break;
 
-                // Swap the buffers of the window.
+                // Swap the buffers of the window, or hand the frame to the render thread if pipelined.
                 window.update();
 
                 frames++;
@@ -573,10 +618,90 @@ namespace EcoSort {
                 frameAccumulator += dt;
                 if (frameAccumulator >= 1.0) {
                     window.setTitle(std::format("EcoSort ({} FPS)", frames).c_str());
+#ifdef RG_RENDER_STATS
+                    RenderFrameStats renderStats = RenderStats::getLastFrame();
+                    const RenderCounters& total = renderStats.total;
+                    m_logger.debug("Last frame: {} draws, {} triangles, {} program / {} texture / {} vertex array / {} "
+                        "framebuffer binds, {} uniforms, {} bytes uploaded", total.drawCalls, total.triangles,
+                        total.programBinds, total.textureBinds, total.vertexArrayBinds, total.framebufferBinds,
+                        total.uniforms[0] + total.uniforms[1] + total.uniforms[2] + total.uniforms[3]
+                            + total.uniforms[4], total.bufferBytes);
+#endif
                     frames = 0;
                     frameAccumulator = 0;
                 }
+
+                totalFrames++;
+                if (options.frameLimit && totalFrames >= options.frameLimit) break;
+            }
+
+            if (RenderThread* renderThread = window.getRenderThread()) {
+                m_logger.info("Simulation waited on the render thread for {} frames", renderThread->getWaits());
+            }
+
+            // The GPU timings below belong to the render thread, so it has to be finished first.
+            window.stopRenderThread();
+
+            if (frameCapture.getCaptured()) {
+                frameCapture.finish();
+                m_logger.info("Wrote {} captured frames, waited on the writer {} times",
+                    frameCapture.getCaptured(), frameCapture.getStalls());
+            }
+
+            double runTime = glfwGetTime() - runStartTime;
+            m_logger.info("Ran {} frames in {:.3f}s ({:.3f}ms per frame)",
+                totalFrames, runTime, totalFrames ? runTime * 1000.0 / totalFrames : 0.0);
+
+            FramePacingStats pacingStats = framePacer.getStats();
+            m_logger.info("Frame intervals: min {:.3f}ms, avg {:.3f}ms, max {:.3f}ms, p99 {:.3f}ms, jitter {:.3f}ms",
+                pacingStats.min, pacingStats.average, pacingStats.max, pacingStats.p99, pacingStats.jitter);
+
+            GPUTimer& gpuTimer = window.getRenderer()->getGPUTimer();
+            for (auto& pass : gpuTimer.getPasses()) {
+                GPUTimerStats stats = gpuTimer.getStats(pass.c_str());
+                m_logger.info("GPU {} pass: min {:.3f}ms, avg {:.3f}ms, p99 {:.3f}ms",
+                    pass, stats.min, stats.average, stats.p99);
             }
+
+            m_logger.info("Rendered {} frames with Forward+ and {} deferred",
+                window.getRenderer()->getForwardPlusFrames(), window.getRenderer()->getDeferredFrames());
+
+            auto guiRedraws = window.getRenderer()->getGUIRedrawCounts();
+            m_logger.info("GUI redraws: {} frames skipped, {} partial, {} full",
+                guiRedraws[0], guiRedraws[1], guiRedraws[2]);
+
+            const OverdrawStats& overdrawStats = window.getRenderer()->getOverdrawEstimator().getStats();
+            m_logger.info("G-buffer fragments: {:.0f} per frame over {} frames without the depth pre-pass, "
+                "{:.0f} per frame over {} frames with it (pre-pass wrote {:.0f})",
+                overdrawStats.geometryFragmentsWithoutPrePass, overdrawStats.framesWithoutPrePass,
+                overdrawStats.geometryFragmentsWithPrePass, overdrawStats.framesWithPrePass,
+                overdrawStats.prePassFragments);
+
+            const GLStateStats& glStats = GLState::getStats();
+            m_logger.info("GL state calls: {} issued, {} elided", glStats.issued, glStats.elided);
+
+            MeshHeapStats heapStats = AssetFetcher::getMeshHeap().getStats();
+            m_logger.info("Mesh heap: {} meshes in {} arenas, {} / {} vertices, {} / {} indices, {} free ranges",
+                heapStats.allocations, heapStats.arenas, heapStats.verticesUsed, heapStats.vertexCapacity,
+                heapStats.indicesUsed, heapStats.indexCapacity, heapStats.freeBlocks);
+
+#ifdef RG_RENDER_STATS
+            RenderFrameStats renderTotals = RenderStats::getTotals();
+            unsigned long long renderFrames = std::max(RenderStats::getFrames(), 1ULL);
+            for (unsigned int i = 0; i < renderTotals.passNames.size(); i++) {
+                const RenderCounters& pass = renderTotals.passes[i];
+                m_logger.info("{} pass per frame: {} draws, {} triangles, {} binds, {} bytes uploaded",
+                    renderTotals.passNames[i], pass.drawCalls / renderFrames, pass.triangles / renderFrames,
+                    (pass.programBinds + pass.textureBinds + pass.vertexArrayBinds + pass.framebufferBinds)
+                        / renderFrames, pass.bufferBytes / renderFrames);
+            }
+            RenderStats::dumpCSV("render_stats.csv");
+#endif
+
+#ifdef RG_DEBUG
+            gpuTimer.dumpCSV("gpu_timings.csv");
+            gpuTimer.dumpJSON("gpu_timings.json");
+#endif
         }
 
         m_logger.info("\n\n\nGame score: {} / {}", m_score, totalBoxes);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Interface/FramePacer.h"
 #include "Interface/Logger.h"
 #include "Interface/Window.h"
 #include "q3.h"
@@ -9,10 +10,48 @@
 
 namespace EcoSort {
 
+    struct GameOptions {
+
+        // Render into a hidden window without presenting, so the game can run on machines without a display.
+        bool headless = false;
+        // Stop after this many frames, or run until the window is closed if 0.
+        unsigned int frameLimit = 0;
+        // Advance the game by this many seconds every frame instead of the measured frame time, if above 0.
+        double fixedTimestep = 0.0;
+        // Skip the main menu and start in the game scene.
+        bool startInGame = false;
+        // Draw each frame on a render thread while the next one is simulated.
+        bool pipelined = false;
+        // Ignore anything the driver supports beyond GL 4.1, to compare against the faster paths.
+        bool forceGL41 = false;
+        // Compute lighting at 1 / lightingScale of the resolution (1, 2 or 4). F2 changes it while running.
+        int lightingScale = 1;
+        // Whether the geometry pass is preceded by a depth-only pass, by default decided from each scene's overdraw.
+        DepthPrePassMode depthPrePass = DepthPrePassMode::AUTO;
+        // Deferred or Forward+, by default decided each frame from the number of lights and the resolution.
+        RenderPath renderPath = RenderPath::AUTO;
+
+        PresentMode presentMode = PresentMode::VSYNC;
+        // Frames per second for PresentMode::LIMITED.
+        double targetFrameRate = 60.0;
+        // How many frames the GPU can be behind the CPU before the CPU waits for it.
+        unsigned int maxFramesInFlight = 2;
+
+        // Write every frame to this directory as a PNG, if set.
+        std::string captureDirectory;
+        // Stop capturing after this many frames, or capture until exit if 0.
+        unsigned int captureFrames = 0;
+
+        // Only used in headless mode, since windowed mode picks its own size.
+        int width = 1280,
+            height = 720;
+
+    };
+
     class Game : public q3ContactListener {
     public:
         
-        void run();
+        void run(const GameOptions& options = {});
 
         Logger& getLogger() { return m_logger; }
         static Game* getInstance() { return s_instance; }
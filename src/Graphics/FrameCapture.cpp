@@ -0,0 +1,174 @@
+#include "FrameCapture.h"
+
+#include <cstring>
+#include <filesystem>
+
+#include "Game.h"
+#include "GLState.h"
+#include "stb_image_write.h"
+
+namespace EcoSort {
+
+    FrameCapture::~FrameCapture() {
+        if (m_writer.joinable()) {
+            {
+                std::lock_guard lock(m_mutex);
+                m_stopping = true;
+            }
+            m_queueChanged.notify_all();
+            m_writer.join();
+        }
+
+        for (auto& slot : m_slots) {
+            if (slot.fence) glDeleteSync(slot.fence);
+            if (slot.buffer) glDeleteBuffers(1, &slot.buffer);
+        }
+    }
+
+    void FrameCapture::start(const std::string& directory, unsigned int frameCount) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error) {
+            LOGGER.warn("Failed to create capture directory {}: {}", directory, error.message());
+            return;
+        }
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_directory = directory;
+        }
+        m_frameCount = frameCount;
+        m_nextFrame = 0;
+        m_capturing = true;
+
+        if (!m_writer.joinable()) m_writer = std::thread(&FrameCapture::writerLoop, this);
+
+        LOGGER.info("Capturing frames to {}", directory);
+    }
+
+    void FrameCapture::stop() {
+        m_capturing = false;
+    }
+
+    void FrameCapture::capture(unsigned int framebuffer, int width, int height) {
+        if (!m_capturing) return;
+
+        Slot& slot = m_slots[m_slotIndex];
+        m_slotIndex = (m_slotIndex + 1) % BUFFER_COUNT;
+
+        // This slot's read was queued BUFFER_COUNT frames ago.
+        if (slot.fence) resolve(slot);
+
+        unsigned int size = static_cast<unsigned int>(width * height * 4);
+        if (!slot.buffer) glGenBuffers(1, &slot.buffer);
+
+        GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        if (slot.size != size) {
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+            slot.size = size;
+        }
+
+        GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        // With a pixel pack buffer bound the last argument is an offset into it, and the call returns straight away.
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.width = width;
+        slot.height = height;
+        slot.frame = m_nextFrame++;
+
+        if (m_frameCount && m_nextFrame >= m_frameCount) {
+            LOGGER.info("Captured {} frames", m_nextFrame);
+            stop();
+        }
+    }
+
+    void FrameCapture::finish() {
+        // Resolve oldest first so frames are queued in order.
+        for (unsigned int i = 0; i < BUFFER_COUNT; i++) {
+            Slot& slot = m_slots[(m_slotIndex + i) % BUFFER_COUNT];
+            if (slot.fence) resolve(slot);
+        }
+
+        std::unique_lock lock(m_mutex);
+        m_queueChanged.wait(lock, [&] { return m_jobs.empty() && !m_writing; });
+    }
+
+    void FrameCapture::resolve(Slot& slot) {
+        // The timeout is only there so a lost context can't hang the game.
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000);
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        Job job { {}, slot.width, slot.height, slot.frame };
+        {
+            std::unique_lock lock(m_mutex);
+            if (m_jobs.size() >= MAX_QUEUED) {
+                m_stalls++;
+                m_queueChanged.wait(lock, [&] { return m_jobs.size() < MAX_QUEUED; });
+            }
+            if (!m_freePixels.empty()) {
+                job.pixels = std::move(m_freePixels.back());
+                m_freePixels.pop_back();
+            }
+        }
+        job.pixels.resize(slot.size);
+
+        GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.size, GL_MAP_READ_BIT);
+        if (data) {
+            std::memcpy(job.pixels.data(), data, slot.size);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        if (!data) {
+            LOGGER.warn("Failed to map capture buffer for frame {}", slot.frame);
+            return;
+        }
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_jobs.push(std::move(job));
+        }
+        m_queueChanged.notify_all();
+    }
+
+    void FrameCapture::writerLoop() {
+        // OpenGL's origin is the bottom left, images are stored from the top. Encoding speed matters more than file
+        // size here.
+        stbi_flip_vertically_on_write(1);
+        stbi_write_png_compression_level = 1;
+
+        while (true) {
+            Job job;
+            std::string directory;
+            {
+                std::unique_lock lock(m_mutex);
+                m_queueChanged.wait(lock, [&] { return m_stopping || !m_jobs.empty(); });
+                if (m_jobs.empty()) return;
+                job = std::move(m_jobs.front());
+                m_jobs.pop();
+                m_writing = true;
+                directory = m_directory;
+            }
+            m_queueChanged.notify_all();
+
+            std::string path = std::format("{}/frame_{:06}.png", directory, job.frame);
+            if (!stbi_write_png(path.c_str(), job.width, job.height, 4, job.pixels.data(), job.width * 4)) {
+                LOGGER.warn("Failed to write captured frame: {}", path);
+            }
+
+            {
+                std::lock_guard lock(m_mutex);
+                m_freePixels.push_back(std::move(job.pixels));
+                m_writing = false;
+            }
+            m_queueChanged.notify_all();
+        }
+    }
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/gl.h>
+
+namespace EcoSort {
+
+    // Reads frames back from the GPU and writes them out as numbered PNGs without stalling rendering.
+    //
+    // Each capture only queues a glReadPixels into one of a ring of pixel buffer objects, which the GPU fills in its
+    // own time. A buffer is mapped BUFFER_COUNT frames later, by which point the copy has almost always finished, and
+    // the pixels are handed to a writer thread to be encoded and saved.
+    class FrameCapture {
+    public:
+
+        static constexpr unsigned int BUFFER_COUNT = 3;
+        // Frames waiting to be written before capture has to wait for the writer to catch up.
+        static constexpr unsigned int MAX_QUEUED = 16;
+
+        FrameCapture() = default;
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        // Capture every frame as directory/frame_000000.png and so on, stopping after frameCount frames if it is above
+        // 0.
+        void start(const std::string& directory, unsigned int frameCount = 0);
+        void stop();
+
+        // Queue a read of the first colour attachment of framebuffer, and hand off any reads that are ready. Does
+        // nothing if not capturing. Must be called on the thread with the context.
+        void capture(unsigned int framebuffer, int width, int height);
+
+        // Wait for every outstanding read and for the writer to finish. Must be called on the thread with the context.
+        void finish();
+
+        [[nodiscard]] bool isCapturing() const { return m_capturing; }
+        [[nodiscard]] unsigned int getCaptured() const { return m_nextFrame; }
+        // Number of times capture had to wait on the writer, which means encoding can't keep up with the frame rate.
+        [[nodiscard]] unsigned int getStalls() const { return m_stalls; }
+
+    private:
+
+        struct Slot {
+            unsigned int buffer = 0;
+            unsigned int size = 0;
+            GLsync fence = nullptr;
+            int width = 0,
+                height = 0;
+            unsigned int frame = 0;
+        };
+
+        struct Job {
+            std::vector<unsigned char> pixels;
+            int width,
+                height;
+            unsigned int frame;
+        };
+
+        // Map a slot with a read in flight and queue its pixels for writing.
+        void resolve(Slot& slot);
+        void writerLoop();
+
+        std::array<Slot, BUFFER_COUNT> m_slots {};
+        unsigned int m_slotIndex = 0;
+
+        bool m_capturing = false;
+        std::string m_directory;
+        unsigned int m_frameCount = 0,
+                     m_nextFrame = 0,
+                     m_stalls = 0;
+
+        std::thread m_writer;
+        std::mutex m_mutex;
+        std::condition_variable m_queueChanged;
+        std::queue<Job> m_jobs;
+        // Pixel storage from written frames, kept to avoid reallocating every frame.
+        std::vector<std::vector<unsigned char>> m_freePixels;
+        bool m_writing = false,
+             m_stopping = false;
+
+    };
+
+}
@@ -2,6 +2,8 @@
 
 #include <glad/gl.h>
 
+#include "GLState.h"
+
 namespace EcoSort {
 
     Framebuffer::Framebuffer() : m_handle(0){
@@ -9,15 +11,16 @@ namespace EcoSort {
     }
 
     Framebuffer::~Framebuffer() {
+        GLState::forgetFramebuffer(m_handle);
         glDeleteFramebuffers(1, &m_handle);
     }
 
     void Framebuffer::bind() {
-        glBindFramebuffer(GL_FRAMEBUFFER, m_handle);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, m_handle);
     }
 
     void Framebuffer::unbind() {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
     void Framebuffer::addColorAttachment(Texture& texture, int index) {
@@ -0,0 +1,28 @@
+#include "GLFeatures.h"
+
+#include <glad/gl.h>
+
+#include "Game.h"
+
+namespace EcoSort {
+
+    bool GLFeatures::s_disabled = false;
+    bool GLFeatures::s_directStateAccess = false;
+    bool GLFeatures::s_multiDrawIndirect = false;
+
+    void GLFeatures::detect() {
+        if (s_disabled) {
+            LOGGER.info("Using the GL 4.1 paths only");
+            return;
+        }
+
+        s_directStateAccess = GLAD_GL_VERSION_4_5 || GLAD_GL_ARB_direct_state_access;
+        // The indirect shaders are GLSL 430 and require GL_ARB_shader_draw_parameters for gl_BaseInstanceARB, which a
+        // 4.6 driver doesn't have to advertise even though the feature is core there.
+        s_multiDrawIndirect = GLAD_GL_VERSION_4_3 && GLAD_GL_ARB_shader_draw_parameters;
+
+        LOGGER.info("Direct state access: {}, multi-draw indirect: {}",
+            s_directStateAccess ? "yes" : "no", s_multiDrawIndirect ? "yes" : "no");
+    }
+
+}
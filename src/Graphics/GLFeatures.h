@@ -0,0 +1,32 @@
+#pragma once
+
+namespace EcoSort {
+
+    // Features beyond GL 4.1 core, which is what the game is written against since it is the most macOS supports.
+    // Each one is looked for once the context exists, either as part of the context's version or through the ARB
+    // extension that provides it, and the code using it keeps a 4.1 path for when it is missing.
+    class GLFeatures {
+    public:
+
+        // Must be called with a context current, once glad has been loaded.
+        static void detect();
+        // Report every feature as missing, so only the 4.1 paths are used. Must be called before detect.
+        static void disable() { s_disabled = true; }
+        // For when the indirect programs can't be built after all.
+        static void disableMultiDrawIndirect() { s_multiDrawIndirect = false; }
+
+        // Objects are created and filled without being bound (4.5 or GL_ARB_direct_state_access).
+        [[nodiscard]] static bool hasDirectStateAccess() { return s_directStateAccess; }
+        // glMultiDrawElementsIndirect with per-draw data in a storage buffer, indexed by gl_BaseInstanceARB (4.3 and
+        // GL_ARB_shader_draw_parameters).
+        [[nodiscard]] static bool hasMultiDrawIndirect() { return s_multiDrawIndirect; }
+
+    private:
+
+        static bool s_disabled;
+        static bool s_directStateAccess;
+        static bool s_multiDrawIndirect;
+
+    };
+
+}
@@ -0,0 +1,257 @@
+#include "GLState.h"
+
+#include <array>
+#include <atomic>
+#include <unordered_map>
+
+#include "RenderStats.h"
+
+namespace EcoSort {
+
+    namespace {
+
+        // Used for any cached value that isn't known, so the next call always goes through.
+        constexpr unsigned int UNKNOWN = 0xFFFFFFFF;
+
+        constexpr int MAX_TEXTURE_UNITS = 32;
+
+        struct CachedState {
+
+            unsigned int program = UNKNOWN,
+                         vao = UNKNOWN,
+                         arrayBuffer = UNKNOWN,
+                         readFramebuffer = UNKNOWN,
+                         drawFramebuffer = UNKNOWN;
+
+            // The element array buffer binding is part of the vertex array's state, so it is cached per vertex array.
+            std::unordered_map<unsigned int, unsigned int> elementBuffers;
+
+            int activeUnit = -1;
+            std::array<unsigned int, MAX_TEXTURE_UNITS> textures;
+
+            // 0 for disabled, 1 for enabled. Capabilities not in the map are unknown.
+            std::unordered_map<GLenum, int> capabilities;
+
+            GLenum blendEquation = UNKNOWN,
+                   blendSource = UNKNOWN,
+                   blendDestination = UNKNOWN,
+                   depthFunc = UNKNOWN,
+                   cullFace = UNKNOWN,
+                   frontFace = UNKNOWN;
+
+            // 0 for no writes, 1 for writes and -1 for unknown. The colour mask is only ever set for every channel.
+            int depthMask = -1,
+                colorMask = -1;
+
+            std::array<int, 4> viewport = { -1, -1, -1, -1 },
+                               scissor = { -1, -1, -1, -1 };
+
+            std::array<float, 4> clearColor = { -1.0f, -1.0f, -1.0f, -1.0f };
+            bool clearColorKnown = false;
+
+            CachedState() { textures.fill(UNKNOWN); }
+
+        };
+
+        CachedState& state() {
+            thread_local CachedState s_state;
+            return s_state;
+        }
+
+        // Relaxed since they are only counters, nothing is ordered by them.
+        std::atomic<unsigned long long> s_issued = 0,
+                                        s_elided = 0;
+
+        void countIssued() { s_issued.fetch_add(1, std::memory_order_relaxed); }
+        void countElided() { s_elided.fetch_add(1, std::memory_order_relaxed); }
+
+        // Returns true if the call needs to be issued, and updates the cached value and counters.
+        template<typename T>
+        bool update(T& cached, T value) {
+            if (cached == value) {
+                countElided();
+                return false;
+            }
+            cached = value;
+            countIssued();
+            return true;
+        }
+
+    }
+
+    void GLState::useProgram(unsigned int program) {
+        if (!update(state().program, program)) return;
+        glUseProgram(program);
+        RG_RENDER_STAT(countProgramBind());
+    }
+
+    void GLState::bindVertexArray(unsigned int vao) {
+        if (!update(state().vao, vao)) return;
+        glBindVertexArray(vao);
+        RG_RENDER_STAT(countVertexArrayBind());
+    }
+
+    void GLState::bindBuffer(GLenum target, unsigned int buffer) {
+        CachedState& s = state();
+        switch (target) {
+            case GL_ARRAY_BUFFER:
+                if (update(s.arrayBuffer, buffer)) glBindBuffer(target, buffer);
+                return;
+            case GL_ELEMENT_ARRAY_BUFFER: {
+                // Without a known vertex array there is nothing to cache against.
+                if (s.vao == UNKNOWN) break;
+                auto [ it, inserted ] = s.elementBuffers.try_emplace(s.vao, UNKNOWN);
+                if (update(it->second, buffer)) glBindBuffer(target, buffer);
+                return;
+            }
+            default:
+                break;
+        }
+        countIssued();
+        glBindBuffer(target, buffer);
+    }
+
+    void GLState::bindFramebuffer(GLenum target, unsigned int framebuffer) {
+        CachedState& s = state();
+        switch (target) {
+            case GL_READ_FRAMEBUFFER:
+                if (!update(s.readFramebuffer, framebuffer)) return;
+                break;
+            case GL_DRAW_FRAMEBUFFER:
+                if (!update(s.drawFramebuffer, framebuffer)) return;
+                break;
+            default:
+                // GL_FRAMEBUFFER binds both, so it can only be skipped if both are already bound.
+                if (s.readFramebuffer == framebuffer && s.drawFramebuffer == framebuffer) {
+                    countElided();
+                    return;
+                }
+                s.readFramebuffer = framebuffer;
+                s.drawFramebuffer = framebuffer;
+                countIssued();
+        }
+        glBindFramebuffer(target, framebuffer);
+        RG_RENDER_STAT(countFramebufferBind());
+    }
+
+    void GLState::activeTexture(int unit) {
+        if (update(state().activeUnit, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    void GLState::bindTexture(unsigned int texture) {
+        CachedState& s = state();
+        if (s.activeUnit < 0 || s.activeUnit >= MAX_TEXTURE_UNITS) countIssued();
+        else if (!update(s.textures[s.activeUnit], texture)) return;
+        glBindTexture(GL_TEXTURE_2D, texture);
+        RG_RENDER_STAT(countTextureBind());
+    }
+
+    void GLState::setEnabled(GLenum capability, bool enabled) {
+        auto [ it, inserted ] = state().capabilities.try_emplace(capability, -1);
+        if (!update(it->second, static_cast<int>(enabled))) return;
+        if (enabled) glEnable(capability);
+        else glDisable(capability);
+    }
+
+    void GLState::blendEquation(GLenum equation) {
+        if (update(state().blendEquation, equation)) glBlendEquation(equation);
+    }
+
+    void GLState::blendFunc(GLenum source, GLenum destination) {
+        CachedState& s = state();
+        if (s.blendSource == source && s.blendDestination == destination) {
+            countElided();
+            return;
+        }
+        s.blendSource = source;
+        s.blendDestination = destination;
+        countIssued();
+        glBlendFunc(source, destination);
+    }
+
+    void GLState::depthFunc(GLenum func) {
+        if (update(state().depthFunc, func)) glDepthFunc(func);
+    }
+
+    void GLState::depthMask(bool write) {
+        if (update(state().depthMask, static_cast<int>(write))) glDepthMask(write ? GL_TRUE : GL_FALSE);
+    }
+
+    void GLState::colorMask(bool write) {
+        GLboolean mask = write ? GL_TRUE : GL_FALSE;
+        if (update(state().colorMask, static_cast<int>(write))) glColorMask(mask, mask, mask, mask);
+    }
+
+    void GLState::cullFace(GLenum face) {
+        if (update(state().cullFace, face)) glCullFace(face);
+    }
+
+    void GLState::frontFace(GLenum face) {
+        if (update(state().frontFace, face)) glFrontFace(face);
+    }
+
+    void GLState::viewport(int x, int y, int width, int height) {
+        if (update(state().viewport, std::array<int, 4> { x, y, width, height })) glViewport(x, y, width, height);
+    }
+
+    void GLState::scissor(int x, int y, int width, int height) {
+        if (update(state().scissor, std::array<int, 4> { x, y, width, height })) glScissor(x, y, width, height);
+    }
+
+    void GLState::clearColor(float r, float g, float b, float a) {
+        CachedState& s = state();
+        std::array<float, 4> colour = { r, g, b, a };
+        if (s.clearColorKnown && s.clearColor == colour) {
+            countElided();
+            return;
+        }
+        s.clearColor = colour;
+        s.clearColorKnown = true;
+        countIssued();
+        glClearColor(r, g, b, a);
+    }
+
+    void GLState::forgetProgram(unsigned int program) {
+        if (state().program == program) state().program = UNKNOWN;
+    }
+
+    void GLState::forgetVertexArray(unsigned int vao) {
+        CachedState& s = state();
+        if (s.vao == vao) s.vao = UNKNOWN;
+        s.elementBuffers.erase(vao);
+    }
+
+    void GLState::forgetBuffer(unsigned int buffer) {
+        CachedState& s = state();
+        if (s.arrayBuffer == buffer) s.arrayBuffer = UNKNOWN;
+        for (auto& [ vao, elementBuffer ] : s.elementBuffers) {
+            if (elementBuffer == buffer) elementBuffer = UNKNOWN;
+        }
+    }
+
+    void GLState::forgetFramebuffer(unsigned int framebuffer) {
+        CachedState& s = state();
+        if (s.readFramebuffer == framebuffer) s.readFramebuffer = UNKNOWN;
+        if (s.drawFramebuffer == framebuffer) s.drawFramebuffer = UNKNOWN;
+    }
+
+    void GLState::forgetTexture(unsigned int texture) {
+        for (auto& bound : state().textures) {
+            if (bound == texture) bound = UNKNOWN;
+        }
+    }
+
+    void GLState::invalidate() {
+        state() = CachedState();
+    }
+
+    GLStateStats GLState::getStats() {
+        return { s_issued.load(std::memory_order_relaxed), s_elided.load(std::memory_order_relaxed) };
+    }
+
+    void GLState::resetStats() {
+        s_issued = 0;
+        s_elided = 0;
+    }
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glad/gl.h>
+
+namespace EcoSort {
+
+    struct GLStateStats {
+
+        // Calls that were passed on to OpenGL.
+        unsigned long long issued = 0;
+        // Calls that were skipped because they would not have changed any state.
+        unsigned long long elided = 0;
+
+    };
+
+    // A cache of the OpenGL state that is changed by the graphics classes. Every bind, enable and state function goes
+    // through here so calls that would set state to what it already is can be skipped before they reach the driver.
+    // There is one cache per thread, since a context is only ever current on one thread at a time, and it assumes
+    // nothing changes the cached state behind its back.
+    class GLState {
+    public:
+
+        static void useProgram(unsigned int program);
+        static void bindVertexArray(unsigned int vao);
+        static void bindBuffer(GLenum target, unsigned int buffer);
+        static void bindFramebuffer(GLenum target, unsigned int framebuffer);
+
+        static void activeTexture(int unit);
+        static void bindTexture(unsigned int texture);
+
+        static void setEnabled(GLenum capability, bool enabled);
+        static void enable(GLenum capability) { setEnabled(capability, true); }
+        static void disable(GLenum capability) { setEnabled(capability, false); }
+
+        static void blendEquation(GLenum equation);
+        static void blendFunc(GLenum source, GLenum destination);
+        static void depthFunc(GLenum func);
+        // glClear respects both masks, so they must be restored before clearing the buffers they cover.
+        static void depthMask(bool write);
+        static void colorMask(bool write);
+        static void cullFace(GLenum face);
+        static void frontFace(GLenum face);
+        static void viewport(int x, int y, int width, int height);
+        static void scissor(int x, int y, int width, int height);
+        static void clearColor(float r, float g, float b, float a);
+
+        // OpenGL silently unbinds objects when they are deleted and may then reuse their names, so the cache must be
+        // told about deletions to avoid skipping binds of a new object with an old name.
+        static void forgetProgram(unsigned int program);
+        static void forgetVertexArray(unsigned int vao);
+        static void forgetBuffer(unsigned int buffer);
+        static void forgetFramebuffer(unsigned int framebuffer);
+        static void forgetTexture(unsigned int texture);
+
+        // Forget everything, for when the context changes or something outside the cache has changed the state.
+        static void invalidate();
+
+        // Totals across every thread.
+        [[nodiscard]] static GLStateStats getStats();
+        static void resetStats();
+
+    };
+
+}
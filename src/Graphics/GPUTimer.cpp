@@ -0,0 +1,161 @@
+#include "GPUTimer.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "Game.h"
+#include "glad/gl.h"
+#include "RenderStats.h"
+
+namespace EcoSort {
+
+    GPUTimer::~GPUTimer() {
+        for (auto& frame : m_frames) {
+            if (frame.pool.empty()) continue;
+            glDeleteQueries(static_cast<GLsizei>(frame.pool.size()), frame.pool.data());
+        }
+    }
+
+    // Move to the next frame slot in the ring. The queries in that slot were issued FRAMES_IN_FLIGHT frames ago, so
+    // their results are almost always ready and can be read without stalling.
+    void GPUTimer::beginFrame() {
+        if (!m_openPasses.empty()) {
+            LOGGER.warn("GPU timer frame started with {} pass(es) still open", m_openPasses.size());
+            m_openPasses.clear();
+        }
+
+        m_frameIndex = (m_frameIndex + 1) % FRAMES_IN_FLIGHT;
+
+        FrameQueries& frame = m_frames[m_frameIndex];
+        collect(frame);
+        frame.pending.clear();
+        frame.used = 0;
+    }
+
+    void GPUTimer::begin(const char* pass) {
+        FrameQueries& frame = m_frames[m_frameIndex];
+
+        PendingQuery query = { getPassIndex(pass), acquireQuery(), acquireQuery() };
+        // GL_TIMESTAMP is used instead of GL_TIME_ELAPSED since only one GL_TIME_ELAPSED query can be active at a
+        // time, which would stop passes from being nested.
+        glQueryCounter(query.startQuery, GL_TIMESTAMP);
+        RG_RENDER_STAT(beginPass(pass));
+
+        m_openPasses.push_back(static_cast<unsigned int>(frame.pending.size()));
+        frame.pending.push_back(query);
+    }
+
+    void GPUTimer::end() {
+        if (m_openPasses.empty()) {
+            LOGGER.warn("GPU timer pass ended without being started");
+            return;
+        }
+
+        FrameQueries& frame = m_frames[m_frameIndex];
+        glQueryCounter(frame.pending[m_openPasses.back()].endQuery, GL_TIMESTAMP);
+        m_openPasses.pop_back();
+        RG_RENDER_STAT(endPass());
+    }
+
+    GPUTimerStats GPUTimer::getStats(const char* pass) const {
+        for (unsigned int i = 0; i < m_passNames.size(); i++) {
+            if (m_passNames[i] == pass) return computeStats(m_histories[i]);
+        }
+        return {};
+    }
+
+    bool GPUTimer::dumpCSV(const char* path) const {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            LOGGER.warn("Failed to open GPU timing file: {}", path);
+            return false;
+        }
+
+        file << "pass,min_ms,average_ms,p99_ms,samples\n";
+        for (unsigned int i = 0; i < m_passNames.size(); i++) {
+            GPUTimerStats stats = computeStats(m_histories[i]);
+            file << std::format("{},{:.4f},{:.4f},{:.4f},{}\n",
+                m_passNames[i], stats.min, stats.average, stats.p99, stats.samples);
+        }
+        return true;
+    }
+
+    bool GPUTimer::dumpJSON(const char* path) const {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            LOGGER.warn("Failed to open GPU timing file: {}", path);
+            return false;
+        }
+
+        file << "{\n";
+        for (unsigned int i = 0; i < m_passNames.size(); i++) {
+            GPUTimerStats stats = computeStats(m_histories[i]);
+            file << std::format(
+                "    \"{}\": {{ \"min_ms\": {:.4f}, \"average_ms\": {:.4f}, \"p99_ms\": {:.4f}, \"samples\": {} }}{}\n",
+                m_passNames[i], stats.min, stats.average, stats.p99, stats.samples,
+                i + 1 < m_passNames.size() ? "," : "");
+        }
+        file << "}\n";
+        return true;
+    }
+
+    unsigned int GPUTimer::getPassIndex(const char* pass) {
+        for (unsigned int i = 0; i < m_passNames.size(); i++) {
+            if (m_passNames[i] == pass) return i;
+        }
+        m_passNames.emplace_back(pass);
+        m_histories.emplace_back();
+        return static_cast<unsigned int>(m_passNames.size() - 1);
+    }
+
+    unsigned int GPUTimer::acquireQuery() {
+        FrameQueries& frame = m_frames[m_frameIndex];
+        if (frame.used == frame.pool.size()) {
+            unsigned int query;
+            glGenQueries(1, &query);
+            frame.pool.push_back(query);
+        }
+        return frame.pool[frame.used++];
+    }
+
+    void GPUTimer::collect(FrameQueries& frame) {
+        if (frame.pending.empty()) return;
+
+        // If any pass of the frame hasn't finished on the GPU yet the whole frame is dropped instead of waiting on it.
+        // Checking only the last query isn't enough since nested passes end out of order.
+        for (auto& query : frame.pending) {
+            int available = 0;
+            glGetQueryObjectiv(query.endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) return;
+        }
+
+        for (auto& query : frame.pending) {
+            GLuint64 start, end;
+            glGetQueryObjectui64v(query.startQuery, GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(query.endQuery, GL_QUERY_RESULT, &end);
+
+            PassHistory& history = m_histories[query.pass];
+            history.samples[history.next] = static_cast<double>(end - start) / 1000000.0;
+            history.next = (history.next + 1) % HISTORY_SIZE;
+            history.count = std::min(history.count + 1, HISTORY_SIZE);
+        }
+    }
+
+    GPUTimerStats GPUTimer::computeStats(const PassHistory& history) const {
+        GPUTimerStats stats;
+        if (!history.count) return stats;
+
+        std::array<double, HISTORY_SIZE> sorted = history.samples;
+        std::sort(sorted.begin(), sorted.begin() + history.count);
+
+        double total = 0.0;
+        for (unsigned int i = 0; i < history.count; i++) total += sorted[i];
+
+        stats.min = sorted[0];
+        stats.average = total / history.count;
+        stats.p99 = sorted[std::min(history.count - 1, (history.count * 99) / 100)];
+        stats.samples = history.count;
+        return stats;
+    }
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace EcoSort {
+
+    struct GPUTimerStats {
+
+        // All times are in milliseconds.
+        double min = 0.0,
+               average = 0.0,
+               p99 = 0.0;
+
+        unsigned int samples = 0;
+
+    };
+
+    class GPUTimer {
+    public:
+
+        // Number of frames of queries kept in flight. Results are read back this many frames after they were issued
+        // so the CPU never has to wait on the GPU for them.
+        static constexpr unsigned int FRAMES_IN_FLIGHT = 4;
+        // Number of samples per pass that the rolling statistics are computed over.
+        static constexpr unsigned int HISTORY_SIZE = 240;
+
+        GPUTimer() = default;
+        ~GPUTimer();
+
+        GPUTimer(const GPUTimer&) = delete;
+        GPUTimer& operator=(const GPUTimer&) = delete;
+
+        void beginFrame();
+
+        // Passes may be nested, each begin must be matched with an end.
+        void begin(const char* pass);
+        void end();
+
+        [[nodiscard]] GPUTimerStats getStats(const char* pass) const;
+        [[nodiscard]] const std::vector<std::string>& getPasses() const { return m_passNames; }
+
+        bool dumpCSV(const char* path) const;
+        bool dumpJSON(const char* path) const;
+
+    private:
+
+        struct PassHistory {
+            std::array<double, HISTORY_SIZE> samples {};
+            unsigned int count = 0,
+                         next = 0;
+        };
+
+        struct PendingQuery {
+            unsigned int pass;
+            unsigned int startQuery,
+                         endQuery;
+        };
+
+        struct FrameQueries {
+            std::vector<PendingQuery> pending;
+            // Query objects are kept around once created and reused when this frame slot comes around again.
+            std::vector<unsigned int> pool;
+            unsigned int used = 0;
+        };
+
+        unsigned int getPassIndex(const char* pass);
+        unsigned int acquireQuery();
+        void collect(FrameQueries& frame);
+
+        [[nodiscard]] GPUTimerStats computeStats(const PassHistory& history) const;
+
+        std::array<FrameQueries, FRAMES_IN_FLIGHT> m_frames;
+        unsigned int m_frameIndex = 0;
+
+        std::vector<std::string> m_passNames;
+        std::vector<PassHistory> m_histories;
+
+        // Indices into the current frame's pending queries for passes that have begun but not ended.
+        std::vector<unsigned int> m_openPasses;
+
+    };
+
+}
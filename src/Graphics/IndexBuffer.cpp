@@ -2,24 +2,53 @@
 
 #include <glad/gl.h>
 
+#include "GLFeatures.h"
+#include "GLState.h"
+#include "RenderStats.h"
+
 namespace EcoSort {
 
     IndexBuffer::IndexBuffer() : m_handle(0), m_count(0) {
-        glGenBuffers(1, &m_handle);
+        if (GLFeatures::hasDirectStateAccess()) {
+            glCreateBuffers(1, &m_handle);
+        } else {
+            glGenBuffers(1, &m_handle);
+        }
     }
 
     IndexBuffer::~IndexBuffer() {
+        GLState::forgetBuffer(m_handle);
         glDeleteBuffers(1, &m_handle);
     }
     
     void IndexBuffer::bind() {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_handle);
+        GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_handle);
     }
 
     void IndexBuffer::setData(const unsigned int* indices, unsigned int count) {
-        bind();
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), indices, GL_STATIC_DRAW);
         m_count = count;
+        if (indices) RG_RENDER_STAT(countBufferBytes(count * sizeof(unsigned int)));
+
+        if (GLFeatures::hasDirectStateAccess()) {
+            glNamedBufferData(m_handle, count * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+            return;
+        }
+
+        // Binding to GL_ELEMENT_ARRAY_BUFFER would change whichever vertex array is bound, or be an error if there
+        // isn't one, so the data is uploaded through a target that isn't part of any vertex array's state.
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, m_handle);
+        glBufferData(GL_COPY_WRITE_BUFFER, count * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+    }
+
+    void IndexBuffer::setSubData(const unsigned int* indices, unsigned int offset, unsigned int count) {
+        RG_RENDER_STAT(countBufferBytes(count * sizeof(unsigned int)));
+        if (GLFeatures::hasDirectStateAccess()) {
+            glNamedBufferSubData(m_handle, offset * sizeof(unsigned int), count * sizeof(unsigned int), indices);
+            return;
+        }
+
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, m_handle);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset * sizeof(unsigned int), count * sizeof(unsigned int), indices);
     }
     
 }
@@ -10,9 +10,14 @@ namespace EcoSort {
 
         void bind();
         
+        // indices can be null to only allocate storage for count indices.
         void setData(const unsigned int* indices, unsigned int count);
+        // Overwrite count indices starting from the offset-th, within storage already allocated by setData.
+        void setSubData(const unsigned int* indices, unsigned int offset, unsigned int count);
         unsigned int getNumIndices() { return m_count; }
 
+        [[nodiscard]] unsigned int getHandle() const { return m_handle; }
+
     private:
 
         unsigned int m_handle;
@@ -0,0 +1,168 @@
+#include "LightGrid.h"
+
+#include <algorithm>
+
+#include "Game.h"
+#include "GLState.h"
+#include "RenderStats.h"
+
+namespace EcoSort {
+
+    // Matches the renderer's projection.
+    static constexpr float NEAR_PLANE = 0.1f;
+
+    LightGrid::LightGrid() {
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &m_maxTexels);
+
+        glGenBuffers(1, &m_lightBuffer);
+        glGenBuffers(1, &m_tileBuffer);
+        // Buffer textures can't be created over a buffer with no storage.
+        LightData empty {};
+        upload(m_lightBuffer, &empty, sizeof(empty));
+        upload(m_tileBuffer, &empty, sizeof(empty));
+
+        // Created on unit 0, which is rebound for every draw anyway.
+        GLState::activeTexture(0);
+        glGenTextures(1, &m_lightTexture);
+        glBindTexture(GL_TEXTURE_BUFFER, m_lightTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_lightBuffer);
+        glGenTextures(1, &m_tileTexture);
+        glBindTexture(GL_TEXTURE_BUFFER, m_tileTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, m_tileBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    LightGrid::~LightGrid() {
+        unsigned int textures[] = { m_lightTexture, m_tileTexture };
+        glDeleteTextures(2, textures);
+
+        GLState::forgetBuffer(m_lightBuffer);
+        GLState::forgetBuffer(m_tileBuffer);
+        unsigned int buffers[] = { m_lightBuffer, m_tileBuffer };
+        glDeleteBuffers(2, buffers);
+    }
+
+    bool LightGrid::build(const std::vector<LightCommand>& lights, const glm::mat4& projection, const glm::mat4& view,
+        int width, int height) {
+
+        m_tilesX = std::max((width + TILE_SIZE - 1) / TILE_SIZE, 1);
+        m_tilesY = std::max((height + TILE_SIZE - 1) / TILE_SIZE, 1);
+
+        m_lights.clear();
+        m_ranges.clear();
+
+        // Directional lights go first so the shader can loop over them by index.
+        for (auto& light : lights) {
+            if (light.type != LightComponent::LightType::DIRECTIONAL) continue;
+            m_lights.push_back({
+                glm::vec4(light.position, light.distance),
+                glm::vec4(light.direction, static_cast<float>(light.type)),
+                glm::vec4(light.colour, 0.0f)
+            });
+        }
+        m_directionalLights = static_cast<int>(m_lights.size());
+
+        for (auto& light : lights) {
+            if (light.type == LightComponent::LightType::DIRECTIONAL) continue;
+
+            glm::vec3 centre = glm::vec3(view * glm::vec4(light.position, 1.0f));
+            float radius = light.distance;
+
+            // The camera looks down -z, so a sphere that is entirely beyond the near plane towards +z can't be seen.
+            if (centre.z - radius >= -NEAR_PLANE) continue;
+
+            TileRange range = { 0, 0, m_tilesX - 1, m_tilesY - 1 };
+
+            // A sphere crossing the near plane can cover any part of the screen, so it goes in every tile.
+            if (centre.z + radius < -NEAR_PLANE) {
+                // The screen bounds of the sphere's bounding box, which are never smaller than the sphere's own.
+                glm::vec2 minimum(1.0f), maximum(-1.0f);
+                for (int corner = 0; corner < 8; corner++) {
+                    glm::vec3 offset((corner & 1) ? radius : -radius, (corner & 2) ? radius : -radius,
+                        (corner & 4) ? radius : -radius);
+                    glm::vec4 clip = projection * glm::vec4(centre + offset, 1.0f);
+                    glm::vec2 ndc = glm::vec2(clip) / clip.w;
+                    minimum = glm::min(minimum, ndc);
+                    maximum = glm::max(maximum, ndc);
+                }
+
+                if (maximum.x < -1.0f || maximum.y < -1.0f || minimum.x > 1.0f || minimum.y > 1.0f) continue;
+
+                auto toTile = [](float ndc, int size, int tiles) {
+                    int pixel = static_cast<int>((std::clamp(ndc, -1.0f, 1.0f) * 0.5f + 0.5f) * size);
+                    return std::clamp(pixel / TILE_SIZE, 0, tiles - 1);
+                };
+                range = {
+                    toTile(minimum.x, width, m_tilesX), toTile(minimum.y, height, m_tilesY),
+                    toTile(maximum.x, width, m_tilesX), toTile(maximum.y, height, m_tilesY)
+                };
+            }
+
+            m_lights.push_back({
+                glm::vec4(light.position, light.distance),
+                glm::vec4(light.direction, static_cast<float>(light.type)),
+                glm::vec4(light.colour, 0.0f)
+            });
+            m_ranges.push_back(range);
+        }
+
+        // Count each tile's lights, turn the counts into offsets, then fill the lists in, so they end up packed one
+        // after another with no per-tile allocations.
+        unsigned int tileCount = static_cast<unsigned int>(m_tilesX * m_tilesY);
+        m_tiles.assign(tileCount * 2, 0);
+
+        for (auto& range : m_ranges) {
+            for (int y = range.minY; y <= range.maxY; y++) {
+                for (int x = range.minX; x <= range.maxX; x++) {
+                    m_tiles[(y * m_tilesX + x) * 2 + 1]++;
+                }
+            }
+        }
+
+        unsigned int offset = tileCount * 2;
+        for (unsigned int tile = 0; tile < tileCount; tile++) {
+            m_tiles[tile * 2] = offset;
+            offset += m_tiles[tile * 2 + 1];
+        }
+        m_tileEntries = offset - tileCount * 2;
+
+        if (offset > static_cast<unsigned int>(m_maxTexels)
+            || m_lights.size() * 3 > static_cast<size_t>(m_maxTexels)) return false;
+
+        m_tiles.resize(offset);
+        // Used as each tile's write cursor, and left as the count once every light is in.
+        for (unsigned int tile = 0; tile < tileCount; tile++) m_tiles[tile * 2 + 1] = 0;
+
+        for (unsigned int i = 0; i < m_ranges.size(); i++) {
+            const TileRange& range = m_ranges[i];
+            unsigned int index = static_cast<unsigned int>(m_directionalLights) + i;
+            for (int y = range.minY; y <= range.maxY; y++) {
+                for (int x = range.minX; x <= range.maxX; x++) {
+                    unsigned int tile = static_cast<unsigned int>(y * m_tilesX + x);
+                    m_tiles[m_tiles[tile * 2] + m_tiles[tile * 2 + 1]++] = index;
+                }
+            }
+        }
+
+        if (!m_lights.empty()) upload(m_lightBuffer, m_lights.data(), m_lights.size() * sizeof(LightData));
+        upload(m_tileBuffer, m_tiles.data(), m_tiles.size() * sizeof(unsigned int));
+        return true;
+    }
+
+    void LightGrid::use(int lightUnit, int tileUnit) const {
+        // The state cache only tracks 2D textures, which buffer textures are bound alongside rather than replacing.
+        GLState::activeTexture(lightUnit);
+        glBindTexture(GL_TEXTURE_BUFFER, m_lightTexture);
+        GLState::activeTexture(tileUnit);
+        glBindTexture(GL_TEXTURE_BUFFER, m_tileTexture);
+    }
+
+    void LightGrid::upload(unsigned int buffer, const void* data, size_t size) {
+        // Respecified every frame, so the driver can hand out fresh storage rather than wait on frames still reading
+        // the old lists.
+        GLState::bindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(size), data, GL_STREAM_DRAW);
+        RG_RENDER_STAT(countBufferBytes(size));
+    }
+
+}
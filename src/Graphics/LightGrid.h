@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include "RenderCommands.h"
+
+namespace EcoSort {
+
+    // Per-tile light lists for Forward+ shading.
+    //
+    // The screen is split into TILE_SIZE pixel tiles and each point and spot light is added to the list of every tile
+    // its bounding sphere covers on screen, so a fragment only has to loop over the lights that can reach it.
+    // Directional lights reach everything, so they are kept at the start of the light data instead of in any list.
+    //
+    // Binning is done on the CPU from the lights' bounds alone, since it has to be done before the frame is drawn and
+    // the depth buffer can't be read back without waiting on the GPU. The lists are uploaded as buffer textures, which
+    // GL 4.1 can read in any shader.
+    class LightGrid {
+    public:
+
+        static constexpr int TILE_SIZE = 16;
+
+        LightGrid();
+        ~LightGrid();
+
+        LightGrid(const LightGrid&) = delete;
+        LightGrid& operator=(const LightGrid&) = delete;
+
+        // Bin lights into the tiles of a width by height viewport seen through projection and view, and upload them.
+        // Returns false without uploading anything if the lists are larger than a buffer texture can hold.
+        bool build(const std::vector<LightCommand>& lights, const glm::mat4& projection, const glm::mat4& view,
+            int width, int height);
+
+        // Bind the light data and the tile lists to the given units, as a samplerBuffer and a usamplerBuffer.
+        void use(int lightUnit, int tileUnit) const;
+
+        [[nodiscard]] int getTilesX() const { return m_tilesX; }
+        [[nodiscard]] int getDirectionalLights() const { return m_directionalLights; }
+        // Total entries across every tile's list, which is how much work the shading pass has beyond ambient.
+        [[nodiscard]] unsigned int getTileEntries() const { return m_tileEntries; }
+
+    private:
+
+        // Laid out as three RGBA32F texels, which is how the shader reads it.
+        struct LightData {
+            // xyz is the position and w the distance.
+            glm::vec4 position;
+            // xyz is the direction and w the LightComponent::LightType.
+            glm::vec4 direction;
+            glm::vec4 colour;
+        };
+
+        // Tiles covered by a light, inclusive at both ends.
+        struct TileRange {
+            int minX, minY,
+                maxX, maxY;
+        };
+
+        static void upload(unsigned int buffer, const void* data, size_t size);
+
+        // GL_MAX_TEXTURE_BUFFER_SIZE, in texels.
+        int m_maxTexels = 65536;
+
+        unsigned int m_lightBuffer = 0,
+                     m_lightTexture = 0,
+                     m_tileBuffer = 0,
+                     m_tileTexture = 0;
+
+        int m_tilesX = 0,
+            m_tilesY = 0;
+        int m_directionalLights = 0;
+        unsigned int m_tileEntries = 0;
+
+        // Kept between frames to reuse their storage.
+        std::vector<LightData> m_lights;
+        std::vector<TileRange> m_ranges;
+        // An offset into the list and a count for each tile, followed by the lists themselves.
+        std::vector<unsigned int> m_tiles;
+
+    };
+
+}
@@ -1,14 +1,14 @@
 #include "Mesh.h"
 
 #include "Game.h"
+#include "RenderStats.h"
 
 namespace EcoSort {
 
     void Mesh::setVertices(std::shared_ptr<VertexBuffer>& vbo) {
         // Always use index 0 for positions for simplicity
-        m_vao->setBuffer(0, *vbo, DataType::FLOAT, DataElements::THREE);
-        // Keep an owning reference of the vbo to ensure the data is kept alive until it is not necessary any more
-        m_buffers.emplace_back(vbo);
+        m_vao->setBuffer(0, vbo, DataType::FLOAT, DataElements::THREE);
+        m_bufferCount++;
     }
 
     void Mesh::setIndices(std::shared_ptr<IndexBuffer>& ibo) {
@@ -31,14 +31,15 @@ namespace EcoSort {
     void Mesh::setBuffer(unsigned int index, std::shared_ptr<VertexBuffer>& vbo, DataType type, DataElements elements) {
         // Ensure the index is not 0, which is reserved for positions, unless the buffer is empty since drawing is not
         // guaranteed to be done with 3-dimensional coordinates.
-        if (!index && !m_buffers.empty()) {
+        if (!index && m_bufferCount) {
             LOGGER.warn("An index of 0 is reserved for positions. Buffer placed at back (index {}) instead.",
-                m_buffers.size());
-            index = m_buffers.size();
+                m_bufferCount);
+            index = m_bufferCount;
         }
-        m_vao->setBuffer(index, *vbo, type, elements);
-        // Keep an owning reference of the vbo to ensure the data is kept alive until it is not necessary any more
-        m_buffers.emplace_back(vbo);
+        // The vertex array keeps an owning reference of the vbo, so the data is kept alive until it is not necessary
+        // any more
+        m_vao->setBuffer(index, vbo, type, elements);
+        m_bufferCount++;
     }
 
     void Mesh::setBuffer(unsigned int index, const void* data, unsigned int size, DataType type, DataElements elements) {
@@ -53,8 +54,16 @@ namespace EcoSort {
         setPrimaryTexture(texture);
     }
 
-    void Mesh::draw() {
-        if (!m_ibo) {
+    unsigned long long Mesh::getSortKey() const {
+        // The vertex array's address stands in for its handle, which doesn't exist until it is first drawn. Meshes in
+        // a heap share their arena's vertex array, so the arena's address is used for them instead.
+        unsigned long long texture = m_primaryTexture ? m_primaryTexture->getHandle() : 0;
+        const void* geometry = m_allocation ? static_cast<const void*>(m_allocation->getArena()) : m_vao.get();
+        return texture << 32 | (reinterpret_cast<uintptr_t>(geometry) & 0xFFFFFFFF);
+    }
+
+    void Mesh::draw() const {
+        if (!m_allocation && !m_ibo) {
             LOGGER.warn("Mesh has no indices");
             return;
         }
@@ -64,10 +73,16 @@ namespace EcoSort {
             m_primaryTexture->bind();
         }
 
+        if (m_allocation) {
+            m_allocation->draw();
+            return;
+        }
+
         m_vao->bind();
         m_ibo->bind();
         
         glDrawElements(GL_TRIANGLES, static_cast<GLint>(m_indexCount), GL_UNSIGNED_INT, nullptr);
+        RG_RENDER_STAT(countDraw(m_indexCount, true));
     }
     
 }
@@ -1,9 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
-#include <vector>
 
 #include "IndexBuffer.h"
+#include "MeshHeap.h"
 #include "Texture.h"
 #include "VertexArray.h"
 
@@ -21,20 +22,29 @@ namespace EcoSort {
         void setBuffer(unsigned int index, const void* data, unsigned int size, DataType type, DataElements elements);
         void setBuffer(unsigned int index, std::shared_ptr<VertexBuffer>& vbo, DataType type, DataElements elements);
 
+        // Draw from a range of a mesh heap instead, which takes the place of any buffers set above.
+        void setAllocation(const std::shared_ptr<MeshAllocation>& allocation) { m_allocation = allocation; }
+
         void setPrimaryTexture(const char* path);
         void setPrimaryTexture(const std::shared_ptr<Texture>& texture) { m_primaryTexture = texture; }
 
-        void draw();
+        void draw() const;
+
+        [[nodiscard]] const std::shared_ptr<MeshAllocation>& getAllocation() const { return m_allocation; }
+        [[nodiscard]] const std::shared_ptr<Texture>& getPrimaryTexture() const { return m_primaryTexture; }
+
+        // Meshes with equal keys share a texture and vertex array, so drawing them one after another binds nothing new.
+        [[nodiscard]] unsigned long long getSortKey() const;
 
     private:
         
         std::shared_ptr<VertexArray> m_vao = std::make_shared<VertexArray>();
         std::shared_ptr<IndexBuffer> m_ibo;
+        std::shared_ptr<MeshAllocation> m_allocation;
 
         std::shared_ptr<Texture> m_primaryTexture;
 
-        std::vector<std::shared_ptr<VertexBuffer>> m_buffers;
-
+        unsigned int m_bufferCount = 0;
         unsigned int m_indexCount = 0;
     };
 }
@@ -0,0 +1,268 @@
+#include "MeshHeap.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "Game.h"
+#include "GLState.h"
+#include "RenderStats.h"
+
+namespace EcoSort {
+
+    static unsigned int getTypeSize(DataType type) {
+        switch (type) {
+            case DataType::BYTE:
+            case DataType::UNSIGNED_BYTE:
+                return 1;
+            case DataType::SHORT:
+            case DataType::UNSIGNED_SHORT:
+                return 2;
+            case DataType::INT:
+            case DataType::UNSIGNED_INT:
+            case DataType::FLOAT:
+                return 4;
+            case DataType::DOUBLE:
+                return 8;
+        }
+        return 0;
+    }
+
+    FreeList::FreeList(unsigned int capacity) : m_capacity(capacity), m_free(capacity) {
+        if (capacity) m_blocks.emplace(0, capacity);
+    }
+
+    long long FreeList::allocate(unsigned int count) {
+        if (!count) return -1;
+
+        // Best fit, which leaves the large ranges alone for the large meshes.
+        auto best = m_blocks.end();
+        for (auto it = m_blocks.begin(); it != m_blocks.end(); ++it) {
+            if (it->second < count) continue;
+            if (best == m_blocks.end() || it->second < best->second) best = it;
+            if (best->second == count) break;
+        }
+        if (best == m_blocks.end()) return -1;
+
+        auto [ offset, size ] = *best;
+        m_blocks.erase(best);
+        if (size > count) m_blocks.emplace(offset + count, size - count);
+
+        m_free -= count;
+        return offset;
+    }
+
+    void FreeList::free(unsigned int offset, unsigned int count) {
+        if (!count) return;
+        m_free += count;
+
+        auto [ it, inserted ] = m_blocks.emplace(offset, count);
+        LOGGER.weakAssert(inserted, "Range at {} was freed twice", offset);
+
+        auto next = std::next(it);
+        if (next != m_blocks.end() && it->first + it->second == next->first) {
+            it->second += next->second;
+            m_blocks.erase(next);
+        }
+
+        if (it != m_blocks.begin()) {
+            auto previous = std::prev(it);
+            if (previous->first + previous->second == it->first) {
+                previous->second += it->second;
+                m_blocks.erase(it);
+            }
+        }
+    }
+
+    MeshArena::MeshArena(const std::vector<HeapAttribute>& layout, unsigned int stride, unsigned int vertices,
+        unsigned int indices) : vertexSpace(vertices), indexSpace(indices) {
+        // The storage is allocated once and meshes are written into it with glBufferSubData.
+        vertexBuffer->setData(nullptr, vertices * stride);
+        indexBuffer.setData(nullptr, indices);
+
+        unsigned int offset = 0;
+        for (auto& attribute : layout) {
+            vertexArray.setBuffer(attribute.index, vertexBuffer, attribute.type, attribute.elements, stride, offset);
+            offset += getTypeSize(attribute.type) * static_cast<unsigned int>(attribute.elements);
+        }
+    }
+
+    MeshAllocation::~MeshAllocation() {
+        if (!m_arena) return;
+
+        std::lock_guard lock(m_arena->mutex);
+        std::erase(m_arena->allocations, this);
+        m_arena->retired.push_back({ m_arena->frame, m_firstVertex, m_vertexCount, m_firstIndex, m_indexCount });
+    }
+
+    void MeshAllocation::bind() const {
+        m_arena->vertexArray.bind();
+        m_arena->indexBuffer.bind();
+    }
+
+    void MeshAllocation::draw() const {
+        bind();
+
+        glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(m_indexCount), GL_UNSIGNED_INT,
+            reinterpret_cast<const void*>(static_cast<uintptr_t>(m_firstIndex) * sizeof(unsigned int)),
+            static_cast<GLint>(m_firstVertex));
+        RG_RENDER_STAT(countDraw(m_indexCount, true));
+    }
+
+    DrawElementsIndirectCommand MeshAllocation::getIndirectCommand(unsigned int baseInstance) const {
+        return { m_indexCount, 1, m_firstIndex, static_cast<int>(m_firstVertex), baseInstance };
+    }
+
+    MeshHeap::MeshHeap(std::vector<HeapAttribute> layout, unsigned int arenaVertices, unsigned int arenaIndices)
+        : m_layout(std::move(layout)), m_arenaVertices(arenaVertices), m_arenaIndices(arenaIndices) {
+        for (auto& attribute : m_layout) {
+            m_stride += getTypeSize(attribute.type) * static_cast<unsigned int>(attribute.elements);
+        }
+    }
+
+    std::shared_ptr<MeshAllocation> MeshHeap::allocate(const void* vertices, unsigned int vertexCount,
+        const unsigned int* indices, unsigned int indexCount) {
+        if (!vertexCount || !indexCount) {
+            LOGGER.warn("Can't place an empty mesh in a heap ({} vertices, {} indices)", vertexCount, indexCount);
+            return nullptr;
+        }
+
+        std::lock_guard lock(m_mutex);
+        std::shared_ptr<MeshAllocation> allocation = reserve(vertexCount, indexCount);
+
+        // The range was either never used or retired long enough ago that no frame in flight can be drawing from it.
+        MeshArena& arena = *allocation->m_arena;
+        arena.vertexBuffer->setSubData(vertices, allocation->m_firstVertex * m_stride, vertexCount * m_stride);
+        arena.indexBuffer.setSubData(indices, allocation->m_firstIndex, indexCount);
+
+        return allocation;
+    }
+
+    void MeshHeap::endFrame() {
+        std::lock_guard lock(m_mutex);
+
+        for (auto& arena : m_arenas) {
+            std::lock_guard arenaLock(arena->mutex);
+            arena->frame++;
+
+            std::erase_if(arena->retired, [&](const MeshArena::Retired& range) {
+                if (arena->frame - range.frame < RETIRE_FRAMES) return false;
+                arena->vertexSpace.free(range.firstVertex, range.vertexCount);
+                arena->indexSpace.free(range.firstIndex, range.indexCount);
+                return true;
+            });
+        }
+    }
+
+    bool MeshHeap::shouldDefragment() const {
+        MeshHeapStats stats = getStats();
+        return stats.arenas > 1 && stats.verticesUsed * 2 < stats.vertexCapacity;
+    }
+
+    void MeshHeap::defragment() {
+        std::lock_guard lock(m_mutex);
+
+        std::vector<std::shared_ptr<MeshArena>> oldArenas = std::move(m_arenas);
+        m_arenas.clear();
+
+        // The largest meshes go first, so the small ones fill the gaps they leave at the end of each arena.
+        std::vector<MeshAllocation*> allocations;
+        for (auto& arena : oldArenas) {
+            std::lock_guard arenaLock(arena->mutex);
+            allocations.insert(allocations.end(), arena->allocations.begin(), arena->allocations.end());
+        }
+        std::ranges::sort(allocations, std::greater {}, &MeshAllocation::m_vertexCount);
+
+        for (MeshAllocation* allocation : allocations) {
+            std::shared_ptr<MeshAllocation> moved = reserve(allocation->m_vertexCount, allocation->m_indexCount);
+            MeshArena& from = *allocation->m_arena;
+            MeshArena& to = *moved->m_arena;
+
+            GLState::bindBuffer(GL_COPY_READ_BUFFER, from.vertexBuffer->getHandle());
+            GLState::bindBuffer(GL_COPY_WRITE_BUFFER, to.vertexBuffer->getHandle());
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                static_cast<GLintptr>(allocation->m_firstVertex) * m_stride,
+                static_cast<GLintptr>(moved->m_firstVertex) * m_stride,
+                static_cast<GLsizeiptr>(allocation->m_vertexCount) * m_stride);
+
+            // Indices are relative to the mesh's first vertex, so they are copied as they are.
+            GLState::bindBuffer(GL_COPY_READ_BUFFER, from.indexBuffer.getHandle());
+            GLState::bindBuffer(GL_COPY_WRITE_BUFFER, to.indexBuffer.getHandle());
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                static_cast<GLintptr>(allocation->m_firstIndex) * sizeof(unsigned int),
+                static_cast<GLintptr>(moved->m_firstIndex) * sizeof(unsigned int),
+                static_cast<GLsizeiptr>(allocation->m_indexCount) * sizeof(unsigned int));
+
+            // Swap the ranges, so the mesh points at its new range and the old one is released with moved.
+            {
+                std::scoped_lock arenaLock(from.mutex, to.mutex);
+                std::erase(from.allocations, allocation);
+                std::erase(to.allocations, moved.get());
+                to.allocations.push_back(allocation);
+                from.allocations.push_back(moved.get());
+            }
+            std::swap(allocation->m_arena, moved->m_arena);
+            std::swap(allocation->m_firstVertex, moved->m_firstVertex);
+            std::swap(allocation->m_firstIndex, moved->m_firstIndex);
+        }
+
+        LOGGER.debug("Defragmented mesh heap from {} arenas to {}", oldArenas.size(), m_arenas.size());
+    }
+
+    MeshHeapStats MeshHeap::getStats() const {
+        std::lock_guard lock(m_mutex);
+
+        MeshHeapStats stats;
+        stats.arenas = static_cast<unsigned int>(m_arenas.size());
+        for (auto& arena : m_arenas) {
+            std::lock_guard arenaLock(arena->mutex);
+            stats.allocations += static_cast<unsigned int>(arena->allocations.size());
+            stats.vertexCapacity += arena->vertexSpace.getCapacity();
+            stats.verticesUsed += arena->vertexSpace.getCapacity() - arena->vertexSpace.getFree();
+            stats.indexCapacity += arena->indexSpace.getCapacity();
+            stats.indicesUsed += arena->indexSpace.getCapacity() - arena->indexSpace.getFree();
+            stats.freeBlocks += arena->vertexSpace.getBlocks();
+        }
+        return stats;
+    }
+
+    std::shared_ptr<MeshArena> MeshHeap::createArena(unsigned int vertices, unsigned int indices) {
+        auto arena = std::make_shared<MeshArena>(m_layout, m_stride, vertices, indices);
+        m_arenas.push_back(arena);
+        LOGGER.debug("Created mesh heap arena {} ({} vertices, {} indices)", m_arenas.size(), vertices, indices);
+        return arena;
+    }
+
+    std::shared_ptr<MeshAllocation> MeshHeap::reserve(unsigned int vertexCount, unsigned int indexCount) {
+        // The constructor is private, so make_shared can't be used.
+        std::shared_ptr<MeshAllocation> allocation(new MeshAllocation());
+        allocation->m_vertexCount = vertexCount;
+        allocation->m_indexCount = indexCount;
+
+        auto tryArena = [&](const std::shared_ptr<MeshArena>& arena) {
+            std::lock_guard arenaLock(arena->mutex);
+
+            long long firstVertex = arena->vertexSpace.allocate(vertexCount);
+            if (firstVertex < 0) return false;
+            long long firstIndex = arena->indexSpace.allocate(indexCount);
+            if (firstIndex < 0) {
+                arena->vertexSpace.free(static_cast<unsigned int>(firstVertex), vertexCount);
+                return false;
+            }
+
+            allocation->m_arena = arena;
+            allocation->m_firstVertex = static_cast<unsigned int>(firstVertex);
+            allocation->m_firstIndex = static_cast<unsigned int>(firstIndex);
+            arena->allocations.push_back(allocation.get());
+            return true;
+        };
+
+        for (auto& arena : m_arenas) {
+            if (tryArena(arena)) return allocation;
+        }
+
+        // Meshes too large for a normal arena get one to themselves.
+        tryArena(createArena(std::max(m_arenaVertices, vertexCount), std::max(m_arenaIndices, indexCount)));
+        return allocation;
+    }
+
+}
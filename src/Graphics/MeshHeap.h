@@ -0,0 +1,183 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+
+#include "Interface/FramePacer.h"
+
+namespace EcoSort {
+
+    // One attribute of a heap's interleaved vertex format.
+    struct HeapAttribute {
+        unsigned int index;
+        DataType type;
+        DataElements elements;
+    };
+
+    struct MeshHeapStats {
+        unsigned int arenas = 0,
+                     allocations = 0;
+        unsigned long long vertexCapacity = 0,
+                           verticesUsed = 0,
+                           indexCapacity = 0,
+                           indicesUsed = 0;
+        // Number of separate free ranges across every arena, which is how fragmented the heap is.
+        unsigned int freeBlocks = 0;
+    };
+
+    // Free ranges of a buffer, in whatever unit it is allocated in. Allocations take the smallest range they fit in
+    // and freed ranges are merged with their neighbours.
+    class FreeList {
+    public:
+
+        explicit FreeList(unsigned int capacity);
+
+        // Returns the offset of the range, or -1 if there is no range large enough.
+        long long allocate(unsigned int count);
+        void free(unsigned int offset, unsigned int count);
+
+        [[nodiscard]] unsigned int getCapacity() const { return m_capacity; }
+        [[nodiscard]] unsigned int getFree() const { return m_free; }
+        [[nodiscard]] unsigned int getBlocks() const { return static_cast<unsigned int>(m_blocks.size()); }
+
+    private:
+
+        // Offset to size.
+        std::map<unsigned int, unsigned int> m_blocks;
+        unsigned int m_capacity;
+        unsigned int m_free;
+
+    };
+
+    // Laid out as glMultiDrawElementsIndirect reads it.
+    struct DrawElementsIndirectCommand {
+        unsigned int count;
+        unsigned int instanceCount;
+        unsigned int firstIndex;
+        int baseVertex;
+        unsigned int baseInstance;
+    };
+
+    class MeshAllocation;
+
+    // A large vertex buffer and index buffer that many meshes are placed in, with a single vertex array describing
+    // them. Each mesh's indices are relative to its own first vertex, so they don't change wherever it ends up.
+    struct MeshArena {
+        MeshArena(const std::vector<HeapAttribute>& layout, unsigned int stride, unsigned int vertices,
+            unsigned int indices);
+
+        std::shared_ptr<VertexBuffer> vertexBuffer = std::make_shared<VertexBuffer>();
+        IndexBuffer indexBuffer;
+        VertexArray vertexArray;
+
+        // Guards everything below, since meshes can be destroyed on the render thread.
+        std::mutex mutex;
+        FreeList vertexSpace,
+                 indexSpace;
+        std::vector<MeshAllocation*> allocations;
+
+        struct Retired {
+            unsigned long long frame;
+            unsigned int firstVertex,
+                         vertexCount,
+                         firstIndex,
+                         indexCount;
+        };
+
+        // Freed ranges are held back until frames that might still be reading them have finished on the GPU.
+        std::vector<Retired> retired;
+        unsigned long long frame = 0;
+    };
+
+    // A mesh's range of vertices and indices in a heap. The range is freed when the last mesh sharing it is destroyed.
+    class MeshAllocation {
+    public:
+
+        ~MeshAllocation();
+
+        MeshAllocation(const MeshAllocation&) = delete;
+        MeshAllocation& operator=(const MeshAllocation&) = delete;
+
+        // Bind the arena's vertex array and index buffer, which is all drawing from the allocation needs.
+        void bind() const;
+        void draw() const;
+
+        // Draws the allocation once, with baseInstance available to shaders as gl_BaseInstanceARB.
+        [[nodiscard]] DrawElementsIndirectCommand getIndirectCommand(unsigned int baseInstance) const;
+
+        // Meshes in the same arena share a vertex array, so they can be drawn one after another with no binds between.
+        [[nodiscard]] const MeshArena* getArena() const { return m_arena.get(); }
+        [[nodiscard]] unsigned int getIndexCount() const { return m_indexCount; }
+
+    private:
+
+        MeshAllocation() = default;
+
+        std::shared_ptr<MeshArena> m_arena;
+        unsigned int m_firstVertex = 0,
+                     m_vertexCount = 0,
+                     m_firstIndex = 0,
+                     m_indexCount = 0;
+
+        friend class MeshHeap;
+
+    };
+
+    // Suballocates static meshes of one vertex format out of a few large buffers, so drawing them needs one vertex
+    // array bind per arena instead of one per mesh, and draws are offset into the buffers with
+    // glDrawElementsBaseVertex.
+    //
+    // Allocation and freeing can happen on any thread with a context sharing the heap's buffers. Freed ranges aren't
+    // reused until endFrame has been called RETIRE_FRAMES times, by which point the frame pacer has made sure the GPU
+    // is done with anything drawn from them.
+    class MeshHeap {
+    public:
+
+        // One more than the most frames the pacer can be configured to keep in flight, so the frame that last drew
+        // from a range has always been waited on.
+        static constexpr unsigned int RETIRE_FRAMES = FramePacer::MAX_FRAMES_IN_FLIGHT + 1;
+
+        MeshHeap(std::vector<HeapAttribute> layout, unsigned int arenaVertices, unsigned int arenaIndices);
+
+        MeshHeap(const MeshHeap&) = delete;
+        MeshHeap& operator=(const MeshHeap&) = delete;
+
+        // vertices is interleaved in the heap's layout.
+        std::shared_ptr<MeshAllocation> allocate(const void* vertices, unsigned int vertexCount,
+            const unsigned int* indices, unsigned int indexCount);
+
+        // Should be called by the thread drawing from the heap once a frame.
+        void endFrame();
+
+        // Fewer than half the allocated vertices are in use, spread over more than one arena.
+        [[nodiscard]] bool shouldDefragment() const;
+        // Pack every allocation into as few arenas as possible and free the rest. Nothing may record or draw from the
+        // heap while this runs, since it moves allocations around.
+        void defragment();
+
+        [[nodiscard]] MeshHeapStats getStats() const;
+        [[nodiscard]] unsigned int getStride() const { return m_stride; }
+
+    private:
+
+        std::shared_ptr<MeshArena> createArena(unsigned int vertices, unsigned int indices);
+        // Reserve a range in one of the arenas, making a new one if none have space. Must be called with m_mutex held.
+        std::shared_ptr<MeshAllocation> reserve(unsigned int vertexCount, unsigned int indexCount);
+
+        std::vector<HeapAttribute> m_layout;
+        unsigned int m_stride = 0;
+        unsigned int m_arenaVertices,
+                     m_arenaIndices;
+
+        mutable std::mutex m_mutex;
+        std::vector<std::shared_ptr<MeshArena>> m_arenas;
+
+    };
+
+}
@@ -0,0 +1,127 @@
+#include "OverdrawEstimator.h"
+
+#include "Game.h"
+#include "glad/gl.h"
+
+namespace EcoSort {
+
+    // Weight given to each new measurement in a scene's average.
+    static constexpr float SMOOTHING = 0.1f;
+
+    // Add a sample to a running average over count samples, count including the new one.
+    static void accumulate(double& average, double sample, unsigned long long count) {
+        average += (sample - average) / static_cast<double>(count);
+    }
+
+    OverdrawEstimator::~OverdrawEstimator() {
+        for (auto& frame : m_frames) {
+            if (!frame.prePassQuery) continue;
+            unsigned int queries[] = { frame.prePassQuery, frame.geometryQuery };
+            glDeleteQueries(2, queries);
+        }
+    }
+
+    bool OverdrawEstimator::beginFrame(unsigned int scene, DepthPrePassMode mode) {
+        m_frameIndex = (m_frameIndex + 1) % FRAMES_IN_FLIGHT;
+
+        FrameQueries& frame = m_frames[m_frameIndex];
+        collect(frame);
+
+        if (!frame.prePassQuery) {
+            unsigned int queries[2];
+            glGenQueries(2, queries);
+            frame.prePassQuery = queries[0];
+            frame.geometryQuery = queries[1];
+        }
+
+        SceneEstimate& estimate = m_scenes[scene];
+        bool prePass;
+        switch (mode) {
+            case DepthPrePassMode::ALWAYS:
+                prePass = true;
+                break;
+            case DepthPrePassMode::NEVER:
+                prePass = false;
+                break;
+            default:
+                // Scenes start with the pre-pass on until they've been measured, which is what measuring needs.
+                prePass = estimate.prePass || ++estimate.framesSinceProbe >= PROBE_INTERVAL;
+                if (prePass) estimate.framesSinceProbe = 0;
+                break;
+        }
+
+        frame.scene = scene;
+        frame.prePass = prePass;
+        frame.issued = false;
+        return prePass;
+    }
+
+    void OverdrawEstimator::beginPrePass() {
+        glBeginQuery(GL_SAMPLES_PASSED, m_frames[m_frameIndex].prePassQuery);
+    }
+
+    void OverdrawEstimator::endPrePass() {
+        glEndQuery(GL_SAMPLES_PASSED);
+    }
+
+    void OverdrawEstimator::beginGeometry() {
+        glBeginQuery(GL_SAMPLES_PASSED, m_frames[m_frameIndex].geometryQuery);
+    }
+
+    void OverdrawEstimator::endGeometry() {
+        glEndQuery(GL_SAMPLES_PASSED);
+        m_frames[m_frameIndex].issued = true;
+    }
+
+    float OverdrawEstimator::getOverdraw(unsigned int scene) const {
+        auto it = m_scenes.find(scene);
+        return it == m_scenes.end() ? 0.0f : it->second.overdraw;
+    }
+
+    void OverdrawEstimator::collect(FrameQueries& frame) {
+        if (!frame.issued) return;
+        frame.issued = false;
+
+        // Dropped rather than waited on if the GPU is running further behind than usual.
+        int available = 0;
+        glGetQueryObjectiv(frame.geometryQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return;
+
+        GLuint64 geometry = 0;
+        glGetQueryObjectui64v(frame.geometryQuery, GL_QUERY_RESULT, &geometry);
+
+        if (!frame.prePass) {
+            m_stats.framesWithoutPrePass++;
+            accumulate(m_stats.geometryFragmentsWithoutPrePass, static_cast<double>(geometry),
+                m_stats.framesWithoutPrePass);
+            return;
+        }
+
+        GLuint64 prePass = 0;
+        glGetQueryObjectui64v(frame.prePassQuery, GL_QUERY_RESULT, &prePass);
+
+        m_stats.framesWithPrePass++;
+        accumulate(m_stats.geometryFragmentsWithPrePass, static_cast<double>(geometry), m_stats.framesWithPrePass);
+        accumulate(m_stats.prePassFragments, static_cast<double>(prePass), m_stats.framesWithPrePass);
+
+        // Nothing on screen says nothing about the scene.
+        if (!geometry) return;
+
+        SceneEstimate& estimate = m_scenes[frame.scene];
+        float overdraw = static_cast<float>(prePass) / static_cast<float>(geometry);
+        // A probe is the only measurement for a long while, so it is taken as it is rather than averaged in.
+        bool smooth = estimate.measured && estimate.prePass;
+        estimate.overdraw = smooth ? estimate.overdraw + (overdraw - estimate.overdraw) * SMOOTHING : overdraw;
+        estimate.measured = true;
+
+        bool wasOn = estimate.prePass;
+        if (estimate.overdraw > ENABLE_OVERDRAW) estimate.prePass = true;
+        else if (estimate.overdraw < DISABLE_OVERDRAW) estimate.prePass = false;
+
+        if (estimate.prePass != wasOn) {
+            LOGGER.debug("Depth pre-pass turned {} at an overdraw of {:.2f}", estimate.prePass ? "on" : "off",
+                estimate.overdraw);
+        }
+    }
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <unordered_map>
+
+namespace EcoSort {
+
+    enum class DepthPrePassMode {
+        // Decided per scene from how much overdraw it has.
+        AUTO,
+        ALWAYS,
+        NEVER
+    };
+
+    struct OverdrawStats {
+
+        unsigned long long framesWithPrePass = 0,
+                           framesWithoutPrePass = 0;
+        // Average samples passing the depth test per frame.
+        double geometryFragmentsWithPrePass = 0.0,
+               geometryFragmentsWithoutPrePass = 0.0,
+               prePassFragments = 0.0;
+
+    };
+
+    // Counts the fragments written by the depth pre-pass and the geometry pass with occlusion queries, and decides
+    // from them whether each scene is worth a pre-pass.
+    //
+    // With the pre-pass, the geometry pass only shades the visible surface of each pixel, and the pre-pass writes
+    // every fragment that was nearer than what was drawn before it. The ratio between the two is the overdraw the
+    // geometry pass would have without the pre-pass, which is only known on frames that have one, so a scene that
+    // has had it turned off gets a probe frame with it every PROBE_INTERVAL frames to see if that has changed.
+    class OverdrawEstimator {
+    public:
+
+        // Results are read this many frames after they were issued, the same as the GPU timer, so the CPU never waits.
+        static constexpr unsigned int FRAMES_IN_FLIGHT = 4;
+        static constexpr unsigned int PROBE_INTERVAL = 120;
+        // Kept apart so a scene hovering around the threshold doesn't switch every few frames.
+        static constexpr float ENABLE_OVERDRAW = 1.5f,
+                               DISABLE_OVERDRAW = 1.2f;
+
+        OverdrawEstimator() = default;
+        ~OverdrawEstimator();
+
+        OverdrawEstimator(const OverdrawEstimator&) = delete;
+        OverdrawEstimator& operator=(const OverdrawEstimator&) = delete;
+
+        // Collect the results from FRAMES_IN_FLIGHT frames ago and return whether this frame should have a pre-pass.
+        // scene is a Scene::getID.
+        bool beginFrame(unsigned int scene, DepthPrePassMode mode);
+
+        // Only one of these can be open at a time.
+        void beginPrePass();
+        void endPrePass();
+        void beginGeometry();
+        void endGeometry();
+
+        [[nodiscard]] const OverdrawStats& getStats() const { return m_stats; }
+        // 0 if the scene hasn't been measured yet.
+        [[nodiscard]] float getOverdraw(unsigned int scene) const;
+
+    private:
+
+        struct FrameQueries {
+            unsigned int prePassQuery = 0,
+                         geometryQuery = 0;
+            unsigned int scene = 0;
+            bool prePass = false,
+                 issued = false;
+        };
+
+        struct SceneEstimate {
+            // A moving average, since a single frame can be unusually good or bad.
+            float overdraw = 0.0f;
+            bool measured = false,
+                 prePass = true;
+            unsigned int framesSinceProbe = 0;
+        };
+
+        void collect(FrameQueries& frame);
+
+        std::array<FrameQueries, FRAMES_IN_FLIGHT> m_frames;
+        unsigned int m_frameIndex = 0;
+
+        std::unordered_map<unsigned int, SceneEstimate> m_scenes;
+        OverdrawStats m_stats;
+
+    };
+
+}
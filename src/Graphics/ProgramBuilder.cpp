@@ -0,0 +1,83 @@
+#include "ProgramBuilder.h"
+
+#include "Game.h"
+#include "ProgramCache.h"
+#include "ShaderPreprocessor.h"
+
+namespace EcoSort {
+
+    void ProgramBuilder::add(ShaderProgram& program, const char* vertexPath, const char* fragmentPath,
+        const std::vector<std::string>& defines) {
+        Entry& entry = m_entries.emplace_back();
+        entry.program = &program;
+        // The cache key is made from the processed sources, so each permutation and any change to an included file
+        // gets its own cache entry.
+        entry.vertexSource = ShaderPreprocessor::process(vertexPath, defines);
+        entry.fragmentSource = ShaderPreprocessor::process(fragmentPath, defines);
+    }
+
+    void ProgramBuilder::build() {
+        enableParallelCompile();
+
+        for (auto& entry : m_entries) {
+            entry.key = ProgramCache::getKey({ &entry.vertexSource, &entry.fragmentSource });
+            entry.cached = ProgramCache::load(entry.program->getHandle(), entry.key);
+        }
+
+        // Issue every compile without waiting on any of them.
+        for (auto& entry : m_entries) {
+            if (entry.cached) continue;
+            entry.vertexShader = std::make_unique<Shader>(ShaderType::VERT, entry.vertexSource, false);
+            entry.fragmentShader = std::make_unique<Shader>(ShaderType::FRAG, entry.fragmentSource, false);
+        }
+
+        // Then every link. The driver waits on the compiles itself where it needs to.
+        for (auto& entry : m_entries) {
+            if (entry.cached) continue;
+            unsigned int handle = entry.program->getHandle();
+            glAttachShader(handle, entry.vertexShader->m_handle);
+            glAttachShader(handle, entry.fragmentShader->m_handle);
+            ProgramCache::prepare(handle);
+            glLinkProgram(handle);
+        }
+
+        // Only now are results queried, by which point the rest of the batch has been compiling in the background.
+        for (auto& entry : m_entries) {
+            if (entry.cached) continue;
+            unsigned int handle = entry.program->getHandle();
+
+            int success;
+            glGetProgramiv(handle, GL_LINK_STATUS, &success);
+            if (!success) {
+                // Compile errors are more useful than the link error they cause, so report those first.
+                entry.vertexShader->checkCompileStatus();
+                entry.fragmentShader->checkCompileStatus();
+                entry.program->checkLinkStatus();
+            }
+
+            // Detach so the shaders are actually deleted when they go out of scope, the binary is all that's needed.
+            glDetachShader(handle, entry.vertexShader->m_handle);
+            glDetachShader(handle, entry.fragmentShader->m_handle);
+
+            ProgramCache::save(handle, entry.key);
+        }
+
+        m_entries.clear();
+    }
+
+    void ProgramBuilder::enableParallelCompile() {
+        static bool enabled = false;
+        if (enabled) return;
+        enabled = true;
+
+        // 0xFFFFFFFF lets the driver pick how many threads to use.
+        if (GLAD_GL_KHR_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+            LOGGER.debug("Using GL_KHR_parallel_shader_compile");
+        } else if (GLAD_GL_ARB_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+            LOGGER.debug("Using GL_ARB_parallel_shader_compile");
+        }
+    }
+
+}
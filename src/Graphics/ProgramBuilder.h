@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+#include "ShaderProgram.h"
+
+namespace EcoSort {
+
+    // Builds a batch of programs together. Every compile is issued before any link and no status is queried until
+    // everything has been submitted, so the driver can compile all the shaders concurrently (with
+    // GL_KHR_parallel_shader_compile on its own threads). Each program is linked exactly once, and programs with a
+    // cached binary skip compiling altogether.
+    class ProgramBuilder {
+    public:
+
+        // Sources are run through ShaderPreprocessor, with defines selecting the permutation to build.
+        void add(ShaderProgram& program, const char* vertexPath, const char* fragmentPath,
+            const std::vector<std::string>& defines = {});
+
+        void build();
+
+    private:
+
+        struct Entry {
+            ShaderProgram* program;
+            std::string vertexSource,
+                        fragmentSource;
+            unsigned long long key = 0;
+            bool cached = false;
+
+            std::unique_ptr<Shader> vertexShader,
+                                    fragmentShader;
+        };
+
+        static void enableParallelCompile();
+
+        std::vector<Entry> m_entries;
+
+    };
+
+}
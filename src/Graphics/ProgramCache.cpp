@@ -0,0 +1,150 @@
+#include "ProgramCache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+#include "Game.h"
+#include "glad/gl.h"
+
+namespace EcoSort {
+
+    unsigned int ProgramCache::s_hits = 0;
+    unsigned int ProgramCache::s_misses = 0;
+
+    namespace {
+
+        // Written at the start of every cache file so files from an older layout are rejected.
+        constexpr unsigned int MAGIC = 0x45435042; // "ECPB"
+
+        struct BinaryHeader {
+            unsigned int magic;
+            unsigned int format;
+            unsigned int length;
+        };
+
+        // 64-bit FNV-1a, which is plenty to tell a handful of shader sources apart.
+        void hash(unsigned long long& h, const void* data, size_t size) {
+            auto bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; i++) {
+                h ^= bytes[i];
+                h *= 0x100000001b3ULL;
+            }
+        }
+
+        void hashString(unsigned long long& h, const char* string) {
+            if (!string) string = "";
+            // The terminator is included so ("ab", "c") and ("a", "bc") hash differently.
+            hash(h, string, std::strlen(string) + 1);
+        }
+
+    }
+
+    unsigned long long ProgramCache::getKey(const std::vector<const std::string*>& sources) {
+        unsigned long long h = 0xcbf29ce484222325ULL;
+
+        for (auto* source : sources) hashString(h, source->c_str());
+
+        hashString(h, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+        hashString(h, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+        hashString(h, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+
+        return h;
+    }
+
+    void ProgramCache::prepare(unsigned int program) {
+        if (!isSupported()) return;
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    bool ProgramCache::load(unsigned int program, unsigned long long key) {
+        if (!isSupported()) return false;
+
+        std::string path = getPath(key);
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            s_misses++;
+            return false;
+        }
+
+        BinaryHeader header {};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        // save writes the binary straight after the header, so the length has to account for the rest of the file
+        // exactly. Anything else is a truncated or corrupt file, and its length can't be trusted as an allocation size.
+        std::error_code sizeError;
+        std::uintmax_t fileSize = std::filesystem::file_size(path, sizeError);
+        bool valid = file && header.magic == MAGIC && !sizeError && fileSize >= sizeof(header)
+            && header.length == fileSize - sizeof(header)
+            && header.length <= static_cast<unsigned int>(std::numeric_limits<GLsizei>::max());
+
+        std::vector<char> binary(valid ? header.length : 0);
+        file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+
+        if (binary.empty() || !file) {
+            LOGGER.warn("Discarding invalid program cache file: {}", path);
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            s_misses++;
+            return false;
+        }
+
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+        // The driver can reject a binary even if the key matches, e.g. after a change it doesn't report in its
+        // version string. The program is then compiled from source as normal.
+        int success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            LOGGER.debug("Driver rejected cached program binary: {}", path);
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            s_misses++;
+            return false;
+        }
+
+        s_hits++;
+        return true;
+    }
+
+    void ProgramCache::save(unsigned int program, unsigned long long key) {
+        if (!isSupported()) return;
+
+        int length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+
+        std::vector<char> binary(length);
+        GLenum format;
+        glGetProgramBinary(program, length, &length, &format, binary.data());
+
+        std::error_code error;
+        std::filesystem::create_directories(DIRECTORY, error);
+
+        std::string path = getPath(key);
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            LOGGER.warn("Failed to write program cache file: {}", path);
+            return;
+        }
+
+        BinaryHeader header = { MAGIC, format, static_cast<unsigned int>(length) };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), length);
+    }
+
+    bool ProgramCache::isSupported() {
+        static int formats = -1;
+        if (formats < 0) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+
+    std::string ProgramCache::getPath(unsigned long long key) {
+        return std::format("{}/{:016x}.bin", DIRECTORY, key);
+    }
+
+}
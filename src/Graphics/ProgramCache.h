@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace EcoSort {
+
+    // Stores linked program binaries on disk so later runs can skip compiling and linking. Binaries are keyed by a
+    // hash of the shader sources and the driver's vendor, renderer and version strings, so editing a shader or
+    // updating the driver invalidates them automatically.
+    class ProgramCache {
+    public:
+
+        static constexpr const char* DIRECTORY = "shader_cache";
+
+        [[nodiscard]] static unsigned long long getKey(const std::vector<const std::string*>& sources);
+
+        // Must be called on a program before it is linked for its binary to be retrievable later.
+        static void prepare(unsigned int program);
+
+        static bool load(unsigned int program, unsigned long long key);
+        static void save(unsigned int program, unsigned long long key);
+
+        [[nodiscard]] static unsigned int getHits() { return s_hits; }
+        [[nodiscard]] static unsigned int getMisses() { return s_misses; }
+
+    private:
+
+        static bool isSupported();
+        static std::string getPath(unsigned long long key);
+
+        static unsigned int s_hits,
+                            s_misses;
+
+    };
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "Graphics/Mesh.h"
+#include "Graphics/OverdrawEstimator.h"
+#include "Graphics/Texture.h"
+#include "Scene/Components.h"
+
+namespace EcoSort {
+
+    // Commands only hold what is needed to issue a draw, with everything derived from the scene (matrices, light
+    // directions, GUI placement) already worked out. Recording them touches no GL state so it can be done on any
+    // thread, and replaying them is just setting uniforms and drawing.
+    //
+    // A command list is a complete snapshot of a frame. It shares ownership of the GL objects it draws with, so it
+    // stays valid even if the entities it was recorded from are changed or removed before it is rendered.
+
+    struct MeshCommand {
+        // Commands are sorted by this before replay so draws sharing a texture and vertex array end up together.
+        unsigned long long sortKey;
+        // Copying a mesh only copies the references to its buffers and texture.
+        Mesh mesh;
+        glm::mat4 model;
+        glm::mat3 normalMatrix;
+    };
+
+    struct LightCommand {
+        LightComponent::LightType type;
+        glm::vec3 position;
+        glm::quat rotation;
+        glm::vec3 direction;
+        glm::vec3 colour;
+        float distance;
+    };
+
+    struct GUICommand {
+        // GUIs without an image are recorded with the white region of the GUI atlas.
+        std::shared_ptr<Texture> image;
+        glm::vec4 uvRect;
+        glm::mat4 model;
+        glm::vec4 colour;
+    };
+
+    struct CameraCommand {
+        float fov;
+        glm::vec3 position;
+        glm::quat rotation;
+    };
+
+    enum class RenderPath {
+        // Forward+ for scenes with few enough lights for their resolution, deferred for the rest.
+        AUTO,
+        DEFERRED,
+        FORWARD_PLUS
+    };
+
+    struct CommandList {
+        // The framebuffer size the frame was laid out for.
+        int width = 0,
+            height = 0;
+
+        // Lighting is computed at 1 / lightingScale of the resolution in each direction and then upsampled.
+        int lightingScale = 1;
+        DepthPrePassMode depthPrePass = DepthPrePassMode::AUTO;
+        RenderPath renderPath = RenderPath::AUTO;
+        // Scene::getID of the scene the frame was recorded from, for settings kept per scene.
+        unsigned int sceneID = 0;
+
+        bool hasCamera = false;
+        CameraCommand camera {};
+
+        std::vector<MeshCommand> meshes;
+        std::vector<LightCommand> lights;
+        std::vector<GUICommand> guis;
+
+        void clear() {
+            meshes.clear();
+            lights.clear();
+            guis.clear();
+        }
+    };
+
+}
@@ -0,0 +1,189 @@
+#include "RenderStats.h"
+
+#include <format>
+#include <fstream>
+#include <mutex>
+
+#include "Game.h"
+
+namespace EcoSort {
+
+    namespace {
+
+        // The frame being counted, on the thread doing the counting.
+        struct Recorder {
+            RenderFrameStats frame;
+            // Indices into frame.passes of the passes that have begun but not ended.
+            std::vector<unsigned int> openPasses;
+        };
+
+        Recorder& recorder() {
+            thread_local Recorder s_recorder;
+            return s_recorder;
+        }
+
+        // Apply add to the frame's total and to the innermost open pass, if there is one.
+        template<typename Add>
+        void addCounts(Add&& add) {
+            Recorder& r = recorder();
+            add(r.frame.total);
+            if (!r.openPasses.empty()) add(r.frame.passes[r.openPasses.back()]);
+        }
+
+        // Sums pass by pass, matching them up by name since a pass can be missing from some frames.
+        void accumulate(RenderFrameStats& into, const RenderFrameStats& frame) {
+            into.total += frame.total;
+            for (unsigned int i = 0; i < frame.passNames.size(); i++) {
+                unsigned int index = 0;
+                while (index < into.passNames.size() && into.passNames[index] != frame.passNames[i]) index++;
+                if (index == into.passNames.size()) {
+                    into.passNames.push_back(frame.passNames[i]);
+                    into.passes.emplace_back();
+                }
+                into.passes[index] += frame.passes[i];
+            }
+        }
+
+        std::mutex s_mutex;
+        RenderFrameStats s_lastFrame,
+                         s_totals;
+        unsigned long long s_frames = 0;
+
+    }
+
+    RenderCounters& RenderCounters::operator+=(const RenderCounters& other) {
+        drawCalls += other.drawCalls;
+        triangles += other.triangles;
+        indices += other.indices;
+        programBinds += other.programBinds;
+        textureBinds += other.textureBinds;
+        vertexArrayBinds += other.vertexArrayBinds;
+        framebufferBinds += other.framebufferBinds;
+        for (size_t i = 0; i < uniforms.size(); i++) uniforms[i] += other.uniforms[i];
+        bufferBytes += other.bufferBytes;
+        return *this;
+    }
+
+    void RenderStats::beginFrame() {
+        Recorder& r = recorder();
+        if (!r.openPasses.empty()) {
+            LOGGER.warn("Render stats frame started with {} pass(es) still open", r.openPasses.size());
+            r.openPasses.clear();
+        }
+
+        {
+            std::lock_guard lock(s_mutex);
+            // Work done before the first frame is loading, not rendering, so it isn't published.
+            if (r.frame.total.drawCalls || !r.frame.passNames.empty()) {
+                accumulate(s_totals, r.frame);
+                s_lastFrame = r.frame;
+                s_frames++;
+            }
+        }
+
+        // Pass names are kept so the same passes don't have to be looked up and allocated again every frame.
+        r.frame.total = {};
+        for (auto& pass : r.frame.passes) pass = {};
+    }
+
+    void RenderStats::beginPass(const char* pass) {
+        RenderFrameStats& frame = recorder().frame;
+        unsigned int index = 0;
+        while (index < frame.passNames.size() && frame.passNames[index] != pass) index++;
+        if (index == frame.passNames.size()) {
+            frame.passNames.emplace_back(pass);
+            frame.passes.emplace_back();
+        }
+        recorder().openPasses.push_back(index);
+    }
+
+    void RenderStats::endPass() {
+        Recorder& r = recorder();
+        if (r.openPasses.empty()) {
+            LOGGER.warn("Render stats pass ended without being started");
+            return;
+        }
+        r.openPasses.pop_back();
+    }
+
+    void RenderStats::countDraw(unsigned long long count, bool indexed) {
+        addCounts([&](RenderCounters& counters) {
+            counters.drawCalls++;
+            counters.triangles += count / 3;
+            if (indexed) counters.indices += count;
+        });
+    }
+
+    void RenderStats::countProgramBind() {
+        addCounts([](RenderCounters& counters) { counters.programBinds++; });
+    }
+
+    void RenderStats::countTextureBind() {
+        addCounts([](RenderCounters& counters) { counters.textureBinds++; });
+    }
+
+    void RenderStats::countVertexArrayBind() {
+        addCounts([](RenderCounters& counters) { counters.vertexArrayBinds++; });
+    }
+
+    void RenderStats::countFramebufferBind() {
+        addCounts([](RenderCounters& counters) { counters.framebufferBinds++; });
+    }
+
+    void RenderStats::countUniform(UniformType type) {
+        addCounts([&](RenderCounters& counters) { counters.uniforms[static_cast<int>(type)]++; });
+    }
+
+    void RenderStats::countBufferBytes(unsigned long long bytes) {
+        addCounts([&](RenderCounters& counters) { counters.bufferBytes += bytes; });
+    }
+
+    RenderFrameStats RenderStats::getLastFrame() {
+        std::lock_guard lock(s_mutex);
+        return s_lastFrame;
+    }
+
+    RenderFrameStats RenderStats::getTotals() {
+        std::lock_guard lock(s_mutex);
+        return s_totals;
+    }
+
+    unsigned long long RenderStats::getFrames() {
+        std::lock_guard lock(s_mutex);
+        return s_frames;
+    }
+
+    bool RenderStats::dumpCSV(const char* path) {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            LOGGER.warn("Failed to open render stats file: {}", path);
+            return false;
+        }
+
+        RenderFrameStats totals;
+        unsigned long long frames;
+        {
+            std::lock_guard lock(s_mutex);
+            totals = s_totals;
+            frames = s_frames;
+        }
+        double scale = frames ? 1.0 / static_cast<double>(frames) : 0.0;
+
+        auto writeRow = [&](const std::string& name, const RenderCounters& counters) {
+            file << name;
+            for (unsigned long long value : {
+                counters.drawCalls, counters.triangles, counters.indices, counters.programBinds, counters.textureBinds,
+                counters.vertexArrayBinds, counters.framebufferBinds, counters.uniforms[0], counters.uniforms[1],
+                counters.uniforms[2], counters.uniforms[3], counters.uniforms[4], counters.bufferBytes
+            }) file << std::format(",{:.2f}", static_cast<double>(value) * scale);
+            file << "\n";
+        };
+
+        file << "pass,draw_calls,triangles,indices,program_binds,texture_binds,vertex_array_binds,framebuffer_binds,"
+            "int_uniforms,float_uniforms,double_uniforms,matrix_uniforms,double_matrix_uniforms,buffer_bytes\n";
+        writeRow("Frame", totals.total);
+        for (unsigned int i = 0; i < totals.passNames.size(); i++) writeRow(totals.passNames[i], totals.passes[i]);
+        return true;
+    }
+
+}
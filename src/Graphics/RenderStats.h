@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+// Every count goes through this, so a build without RG_RENDER_STATS doesn't even evaluate the arguments.
+#ifdef RG_RENDER_STATS
+#define RG_RENDER_STAT(call) EcoSort::RenderStats::call
+#else
+#define RG_RENDER_STAT(call) ((void) 0)
+#endif
+
+namespace EcoSort {
+
+    enum class UniformType {
+        INT,
+        FLOAT,
+        DOUBLE,
+        MATRIX,
+        DOUBLE_MATRIX
+    };
+
+    struct RenderCounters {
+
+        unsigned long long drawCalls = 0,
+                           triangles = 0,
+                           // Only counted for indexed draws.
+                           indices = 0;
+
+        // Binds that reached OpenGL, after the state cache has skipped the redundant ones.
+        unsigned long long programBinds = 0,
+                           textureBinds = 0,
+                           vertexArrayBinds = 0,
+                           framebufferBinds = 0;
+
+        // Indexed by UniformType.
+        std::array<unsigned long long, 5> uniforms {};
+
+        // Written to buffers by the CPU, whether by glBufferData, glBufferSubData or a mapping.
+        unsigned long long bufferBytes = 0;
+
+        RenderCounters& operator+=(const RenderCounters& other);
+
+    };
+
+    struct RenderFrameStats {
+
+        // Everything in the frame, including work done outside of any pass.
+        RenderCounters total;
+
+        // Each pass's own work, not including passes nested inside it, in the order they were first seen.
+        std::vector<std::string> passNames;
+        std::vector<RenderCounters> passes;
+
+    };
+
+    // Counts the work the renderer submits to OpenGL, per frame and per GPUTimer pass. Counting is done on whichever
+    // thread the context is current on, and the finished frame is published in beginFrame so it can be read from any
+    // other thread.
+    //
+    // Only call through RG_RENDER_STAT, so it all disappears when RG_RENDER_STATS isn't defined.
+    class RenderStats {
+    public:
+
+        // Publish the frame counted since the last call and start counting a new one.
+        static void beginFrame();
+
+        // Passes may be nested, and work is counted against the innermost one.
+        static void beginPass(const char* pass);
+        static void endPass();
+
+        // Every draw the renderer makes is of triangles, so count is the number of vertices read, or indices for an
+        // indexed draw. A multi-draw is counted as one call with the sum of its draws' counts.
+        static void countDraw(unsigned long long count, bool indexed);
+        static void countProgramBind();
+        static void countTextureBind();
+        static void countVertexArrayBind();
+        static void countFramebufferBind();
+        static void countUniform(UniformType type);
+        static void countBufferBytes(unsigned long long bytes);
+
+        // The last frame published, which is empty until the first one has finished.
+        [[nodiscard]] static RenderFrameStats getLastFrame();
+        // The sum of every frame published, and how many there were.
+        [[nodiscard]] static RenderFrameStats getTotals();
+        [[nodiscard]] static unsigned long long getFrames();
+
+        // Per pass averages over every frame published.
+        static bool dumpCSV(const char* path);
+
+    };
+
+}
@@ -1,50 +1,96 @@
 #include "RenderTarget.h"
 
+#include <algorithm>
+
 #include "Game.h"
+#include "GLState.h"
 
 namespace EcoSort {
 
+    RenderTarget::RenderTarget(int width, int height)
+        : m_width(width), m_height(height), m_allocatedWidth(getBucket(width)), m_allocatedHeight(getBucket(height)) {}
+
     void RenderTarget::addAttachment(TextureDescriptor descriptor) {
-        auto& pair = m_attachments.emplace_back(std::make_shared<Texture>(), descriptor);
-        Texture* texture = pair.first.get();
-        m_attachments.back().second = descriptor;
-        texture->setData(m_width, m_height, descriptor);
-        if (descriptor.type == TextureType::DEPTH) {
-            m_framebuffer.addDepthAttachment(*texture);
-            return;
-        }
-        m_framebuffer.addColorAttachment(*texture, m_attachments.size() - 1);
-        auto* buffers = new unsigned int[m_attachments.size()];
+        m_attachments.emplace_back(createAttachment(descriptor), descriptor);
+        attach(m_attachments.size() - 1);
+
+        if (descriptor.type == TextureType::DEPTH) return;
+
+        std::vector<unsigned int> buffers;
         for (int i = 0; i < m_attachments.size(); i++) {
-            buffers[i] = GL_COLOR_ATTACHMENT0 + i;
+            if (m_attachments[i].second.type == TextureType::DEPTH) continue;
+            buffers.push_back(GL_COLOR_ATTACHMENT0 + i);
         }
-        glDrawBuffers(m_attachments.size(), buffers);
-        delete[] buffers;
+        glDrawBuffers(static_cast<GLsizei>(buffers.size()), buffers.data());
     }
 
     void RenderTarget::resize(int width, int height) {
+        if (width <= 0 || height <= 0) return;
+
         m_width = width;
         m_height = height;
 
-        for (auto& [ tex, desc ] : m_attachments) {
-            tex->setData(m_width, m_height, desc);
+        int bucketWidth = getBucket(width);
+        int bucketHeight = getBucket(height);
+        if (bucketWidth == m_allocatedWidth && bucketHeight == m_allocatedHeight) return;
+
+        Allocation previous = { m_allocatedWidth, m_allocatedHeight, {} };
+        for (auto& [ texture, descriptor ] : m_attachments) previous.textures.push_back(texture);
+
+        m_allocatedWidth = bucketWidth;
+        m_allocatedHeight = bucketHeight;
+
+        auto pooled = std::ranges::find_if(m_pool, [&](const Allocation& allocation) {
+            return allocation.width == bucketWidth && allocation.height == bucketHeight;
+        });
+
+        if (pooled != m_pool.end()) {
+            for (int i = 0; i < m_attachments.size(); i++) m_attachments[i].first = pooled->textures[i];
+            m_pool.erase(pooled);
+        } else {
+            for (auto& [ texture, descriptor ] : m_attachments) texture = createAttachment(descriptor);
+            m_allocations++;
         }
+
+        m_pool.insert(m_pool.begin(), std::move(previous));
+        if (m_pool.size() > POOL_SIZE) m_pool.pop_back();
+
+        for (int i = 0; i < m_attachments.size(); i++) attach(i);
     }
 
-    void RenderTarget::use() {
+    void RenderTarget::use(int firstUnit) {
         for (int i = 0; i < m_attachments.size(); i++) {
-            Texture::setUnit(i);
+            Texture::setUnit(firstUnit + i);
             m_attachments[i].first->bind();
         }
         Texture::setUnit(0);
     }
 
     void RenderTarget::bind() {
-        glViewport(0, 0, m_width, m_height);
+        GLState::viewport(0, 0, m_width, m_height);
         m_framebuffer.bind();
         if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
             LOGGER.error("Framebuffer is not complete!");
         }
     }
+
+    int RenderTarget::getBucket(int size) {
+        return std::max(1, (size + BUCKET_SIZE - 1) / BUCKET_SIZE) * BUCKET_SIZE;
+    }
+
+    std::shared_ptr<Texture> RenderTarget::createAttachment(const TextureDescriptor& descriptor) const {
+        auto texture = std::make_shared<Texture>();
+        texture->allocate(m_allocatedWidth, m_allocatedHeight, descriptor);
+        return texture;
+    }
+
+    void RenderTarget::attach(unsigned int index) {
+        auto& [ texture, descriptor ] = m_attachments[index];
+        if (descriptor.type == TextureType::DEPTH) {
+            m_framebuffer.addDepthAttachment(*texture);
+            return;
+        }
+        m_framebuffer.addColorAttachment(*texture, static_cast<int>(index));
+    }
     
 }
@@ -8,26 +8,60 @@
 
 namespace EcoSort {
 
+    // A framebuffer and the textures attached to it.
+    //
+    // Attachments are allocated in BUCKET_SIZE steps larger than the target, and only the top left width by height
+    // region is rendered to, so most resizes change nothing but the viewport. Anything sampling the attachments
+    // should do so by texel (gl_FragCoord) rather than by normalised coordinates across the whole texture. When a
+    // resize does need new attachments, the old ones are kept in a small pool, so resizing back and forth between
+    // sizes doesn't allocate again.
     class RenderTarget {
     public:
+
+        static constexpr int BUCKET_SIZE = 256;
+        // Number of previous allocations kept for reuse.
+        static constexpr unsigned int POOL_SIZE = 2;
         
-        RenderTarget(int width, int height) : m_width(width), m_height(height) {}
+        RenderTarget(int width, int height);
 
         void addAttachment(TextureDescriptor descriptor);
 
         void resize(int width, int height);
 
-        void use();
+        // Bind each attachment to its own texture unit, counting up from firstUnit.
+        void use(int firstUnit = 0);
         void bind();
 
+        // Number of times attachments had to be allocated, including the first.
+        [[nodiscard]] unsigned int getAllocations() const { return m_allocations; }
+
     private:
 
+        struct Allocation {
+            int width,
+                height;
+            std::vector<std::shared_ptr<Texture>> textures;
+        };
+
+        static int getBucket(int size);
+
+        std::shared_ptr<Texture> createAttachment(const TextureDescriptor& descriptor) const;
+        void attach(unsigned int index);
+
         Framebuffer m_framebuffer;
         std::vector<std::pair<std::shared_ptr<Texture>, TextureDescriptor>> m_attachments;
 
         int m_width, 
             m_height;
 
+        // The size the current attachments were allocated at.
+        int m_allocatedWidth,
+            m_allocatedHeight;
+
+        // Most recently used first.
+        std::vector<Allocation> m_pool;
+        unsigned int m_allocations = 1;
+
         friend class Renderer;
         
     };
@@ -8,35 +8,44 @@
 namespace EcoSort {
 
     // Declare and compile a shader from the source found in a file at path.
-    Shader::Shader(const char* path, ShaderType type) : m_type(type) {
+    Shader::Shader(const char* path, ShaderType type) : Shader(type, readSource(path)) {}
 
-        LOGGER.debug("Reading shader source from path: {}", path);
+    // Declare and compile a shader from source that has already been read.
+    Shader::Shader(ShaderType type, const std::string& source, bool checkStatus) : m_type(type) {
 
         m_handle = glCreateShader(static_cast<GLenum>(type));
-        std::string shaderSource;
-
-        std::ifstream file(path);
-        LOGGER.strongAssert(file.is_open(), "Failed to open shader file: {}", path);
-
-        std::stringstream buffer;
-        buffer << file.rdbuf() << '\0';
 
-        file.close();
-
-        shaderSource = buffer.str();
-        const char* ccsrc = shaderSource.c_str();
+        const char* ccsrc = source.c_str();
 
         glShaderSource(m_handle, 1, &ccsrc, nullptr);
         glCompileShader(m_handle);
 
+        if (checkStatus) checkCompileStatus();
+        
+    }
+
+    // Querying the status waits for the compile to finish.
+    void Shader::checkCompileStatus() {
         int success;
         char infoLog[512];
         glGetShaderiv(m_handle, GL_COMPILE_STATUS, &success);
         if (!success) {
             glGetShaderInfoLog(m_handle, 512, nullptr, infoLog);
-            LOGGER.error("{} shader compilation failed: {}", type == ShaderType::VERT ? "Vertex" : "Fragment", infoLog);
+            LOGGER.error("{} shader compilation failed: {}", m_type == ShaderType::VERT ? "Vertex" : "Fragment", infoLog);
         }
-        
+    }
+
+    std::string Shader::readSource(const char* path) {
+
+        LOGGER.debug("Reading shader source from path: {}", path);
+
+        std::ifstream file(path);
+        LOGGER.strongAssert(file.is_open(), "Failed to open shader file: {}", path);
+
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+
+        return buffer.str();
     }
 
     Shader::~Shader() {
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 #include <glad/gl.h>
 
 namespace EcoSort {
@@ -13,8 +15,15 @@ namespace EcoSort {
     public:
 
         Shader(const char* path, ShaderType type);
+        // If checkStatus is false the compile is only issued, so several shaders can compile at once in the driver.
+        // checkCompileStatus should then be called before relying on the result.
+        Shader(ShaderType type, const std::string& source, bool checkStatus = true);
         ~Shader();
 
+        void checkCompileStatus();
+
+        static std::string readSource(const char* path);
+
         ShaderType getType() { return m_type; }
 
     private:
@@ -23,6 +32,7 @@ namespace EcoSort {
         ShaderType m_type;
 
         friend class ShaderProgram;
+        friend class ProgramBuilder;
         
     };
     
@@ -0,0 +1,65 @@
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "Game.h"
+#include "Shader.h"
+
+namespace EcoSort {
+
+    std::string ShaderPreprocessor::process(const char* path, const std::vector<std::string>& defines) {
+        std::vector<std::filesystem::path> included;
+        std::string output;
+        append(path, defines, included, output);
+        return output;
+    }
+
+    void ShaderPreprocessor::append(const std::filesystem::path& path, const std::vector<std::string>& defines,
+        std::vector<std::filesystem::path>& included, std::string& output) {
+
+        std::filesystem::path normalised = path.lexically_normal();
+        if (std::ranges::find(included, normalised) != included.end()) return;
+        included.push_back(normalised);
+
+        std::istringstream source(Shader::readSource(normalised.string().c_str()));
+
+        // Defines are only added to the file being processed, not files it includes, since they must come after
+        // #version which is only in the top level file.
+        bool isRoot = included.size() == 1;
+
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(source, line)) {
+            lineNumber++;
+
+            size_t start = line.find_first_not_of(" \t");
+            std::string_view directive = start == std::string::npos ? "" : std::string_view(line).substr(start);
+
+            if (directive.starts_with("#include")) {
+                size_t open = directive.find('"');
+                size_t close = open == std::string_view::npos ? open : directive.find('"', open + 1);
+                if (close == std::string_view::npos) {
+                    LOGGER.error("Malformed #include in {} on line {}", normalised.string(), lineNumber);
+                    continue;
+                }
+                std::filesystem::path includePath = normalised.parent_path() / directive.substr(open + 1, close - open - 1);
+                append(includePath, defines, included, output);
+                // Keep line numbers in compile errors matching this file.
+                output += std::format("#line {}\n", lineNumber + 1);
+                continue;
+            }
+
+            output += line;
+            output += '\n';
+
+            if (isRoot && directive.starts_with("#version")) {
+                for (auto& define : defines) {
+                    output += "#define " + define + '\n';
+                }
+                if (!defines.empty()) output += std::format("#line {}\n", lineNumber + 1);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace EcoSort {
+
+    class ShaderPreprocessor {
+    public:
+
+        // Read the shader at path, resolving #include "file" directives relative to the including file and adding a
+        // #define after the #version directive for each entry in defines. An entry can be a name ("LIGHT_POINT") or a
+        // name and value ("MAX_LIGHTS 64"). Each file is only included once.
+        static std::string process(const char* path, const std::vector<std::string>& defines = {});
+
+    private:
+
+        static void append(const std::filesystem::path& path, const std::vector<std::string>& defines,
+            std::vector<std::filesystem::path>& included, std::string& output);
+
+    };
+
+}
@@ -2,6 +2,10 @@
 
 #include <Game.h>
 
+#include "GLState.h"
+#include "ProgramBuilder.h"
+#include "RenderStats.h"
+
 namespace EcoSort {
 
     ShaderProgram::ShaderProgram() {
@@ -9,17 +13,22 @@ namespace EcoSort {
     }
 
     ShaderProgram::~ShaderProgram() {
+        GLState::forgetProgram(m_handle);
         glDeleteProgram(m_handle);
     }
 
     void ShaderProgram::use() {
-        glUseProgram(m_handle);
+        GLState::useProgram(m_handle);
     }
 
     // Link the program based on the shaders that are currently attached and check for success.
     void ShaderProgram::link() {
         glLinkProgram(m_handle);
+        checkLinkStatus();
+    }
 
+    // Querying the status waits for the link to finish.
+    void ShaderProgram::checkLinkStatus() {
         int success;
         char infoLog[512];
         glGetProgramiv(m_handle, GL_LINK_STATUS, &success);
@@ -29,11 +38,25 @@ namespace EcoSort {
         }
     }
 
+    bool ShaderProgram::isLinked() {
+        int success;
+        glGetProgramiv(m_handle, GL_LINK_STATUS, &success);
+        return success;
+    }
+
     void ShaderProgram::attachShader(Shader& shader) {
         glAttachShader(m_handle, shader.m_handle);
         link();
     }
 
+    // Build the program from a vertex and fragment shader, linking only once. When building several programs,
+    // ProgramBuilder should be used directly so they all compile at the same time.
+    void ShaderProgram::build(const char* vertexPath, const char* fragmentPath) {
+        ProgramBuilder builder;
+        builder.add(*this, vertexPath, fragmentPath);
+        builder.build();
+    }
+
     int ShaderProgram::getUniformHandle(const char* name) {
         int location = glGetUniformLocation(m_handle, name);
         LOGGER.weakAssert(location != -1, "Uniform '{}' not found in shader program", name);
@@ -42,136 +65,163 @@ namespace EcoSort {
 
     void ShaderProgram::setByte(const char* name, char value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::INT));
         glUniform1i(getUniformHandle(name), value);
     }
 
     void ShaderProgram::setUByte(const char* name, unsigned char value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::INT));
         glUniform1i(getUniformHandle(name), value);
     }
 
     void ShaderProgram::setShort(const char* name, short value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::INT));
         glUniform1i(getUniformHandle(name), value);
     }
 
     void ShaderProgram::setUShort(const char* name, unsigned short value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::INT));
         glUniform1i(getUniformHandle(name), value);
     }
 
     void ShaderProgram::setInt(const char* name, int value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::INT));
         glUniform1i(getUniformHandle(name), value);
     }
 
     void ShaderProgram::setUInt(const char* name, unsigned int value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::INT));
         glUniform1i(getUniformHandle(name), value);
     }
 
     void ShaderProgram::setFloat(const char* name, float value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::FLOAT));
         glUniform1f(getUniformHandle(name), value);
     }
 
     void ShaderProgram::setDouble(const char* name, double value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::DOUBLE));
         glUniform1d(getUniformHandle(name), value);
     }
 
     void ShaderProgram::setMat2(const char* name, const float* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::MATRIX));
         glUniformMatrix2fv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setDMat2(const char* name, const double* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::DOUBLE_MATRIX));
         glUniformMatrix2dv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setMat2x3(const char* name, const float* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::MATRIX));
         glUniformMatrix2x3fv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setDMat2x3(const char* name, const double* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::DOUBLE_MATRIX));
         glUniformMatrix2x3dv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setMat2x4(const char* name, const float* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::MATRIX));
         glUniformMatrix2x4fv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setDMat2x4(const char* name, const double* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::DOUBLE_MATRIX));
         glUniformMatrix2x4dv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setMat3(const char* name, const float* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::MATRIX));
         glUniformMatrix3fv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setDMat3(const char* name, const double* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::DOUBLE_MATRIX));
         glUniformMatrix3dv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setMat3x2(const char* name, const float* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::MATRIX));
         glUniformMatrix3x2fv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setDMat3x2(const char* name, const double* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::DOUBLE_MATRIX));
         glUniformMatrix3x2dv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setMat3x4(const char* name, const float* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::MATRIX));
         glUniformMatrix3x4fv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setDMat3x4(const char* name, const double* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::DOUBLE_MATRIX));
         glUniformMatrix3x4dv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setMat4(const char* name, const float* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::MATRIX));
         glUniformMatrix4fv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setDMat4(const char* name, const double* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::DOUBLE_MATRIX));
         glUniformMatrix4dv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setMat4x2(const char* name, const float* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::MATRIX));
         glUniformMatrix4x2fv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setDMat4x2(const char* name, const double* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::DOUBLE_MATRIX));
         glUniformMatrix4x2dv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setMat4x3(const char* name, const float* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::MATRIX));
         glUniformMatrix4x3fv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setDMat4x3(const char* name, const double* value) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::DOUBLE_MATRIX));
         glUniformMatrix4x3dv(getUniformHandle(name), 1, GL_FALSE, value);
     }
 
     void ShaderProgram::setBytes(const char* name, const char* value, unsigned int num) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::INT));
         int location = getUniformHandle(name);
         auto ptrvalue = reinterpret_cast<const int*>(value);
 
@@ -195,6 +245,7 @@ namespace EcoSort {
 
     void ShaderProgram::setUBytes(const char* name, const unsigned char* value, unsigned int num) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::INT));
         int location = getUniformHandle(name);
         auto ptrvalue = reinterpret_cast<const int*>(value);
 
@@ -218,6 +269,7 @@ namespace EcoSort {
 
     void ShaderProgram::setShorts(const char* name, const short* value, unsigned int num) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::INT));
         int location = getUniformHandle(name);
         auto ptrvalue = reinterpret_cast<const int*>(value);
 
@@ -241,6 +293,7 @@ namespace EcoSort {
 
     void ShaderProgram::setUShorts(const char* name, const unsigned short* value, unsigned int num) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::INT));
         int location = getUniformHandle(name);
         auto ptrvalue = reinterpret_cast<const int*>(value);
 
@@ -264,6 +317,7 @@ namespace EcoSort {
 
     void ShaderProgram::setInts(const char* name, const int* value, unsigned int num) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::INT));
         int location = getUniformHandle(name);
         auto ptrvalue = reinterpret_cast<const int*>(value);
 
@@ -287,6 +341,7 @@ namespace EcoSort {
 
     void ShaderProgram::setUInts(const char* name, const unsigned int* value, unsigned int num) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::INT));
         int location = getUniformHandle(name);
         auto ptrvalue = reinterpret_cast<const int*>(value);
 
@@ -310,6 +365,7 @@ namespace EcoSort {
 
     void ShaderProgram::setFloats(const char* name, const float* value, unsigned int num) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::FLOAT));
         int location = getUniformHandle(name);
         auto ptrvalue = reinterpret_cast<const float*>(value);
 
@@ -333,6 +389,7 @@ namespace EcoSort {
 
     void ShaderProgram::setDoubles(const char* name, const double* value, unsigned int num) {
         use();
+        RG_RENDER_STAT(countUniform(UniformType::DOUBLE));
         int location = getUniformHandle(name);
         auto ptrvalue = reinterpret_cast<const double*>(value);
 
@@ -12,9 +12,13 @@ namespace EcoSort {
 
         void use();
         void link();
+        void checkLinkStatus();
+        [[nodiscard]] bool isLinked();
         
         void attachShader(Shader& shader);
 
+        void build(const char* vertexPath, const char* fragmentPath);
+
         unsigned int getHandle() { return m_handle; }
 
         void setByte(const char* name, char value);
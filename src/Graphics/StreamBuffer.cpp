@@ -0,0 +1,110 @@
+#include "StreamBuffer.h"
+
+#include <cstring>
+
+#include "Game.h"
+#include "GLFeatures.h"
+#include "GLState.h"
+#include "RenderStats.h"
+
+namespace EcoSort {
+
+    StreamBuffer::StreamBuffer(unsigned int frameSize) : m_handle(0), m_frameSize(frameSize) {
+        // The storage is allocated once here and never respecified.
+        if (GLFeatures::hasDirectStateAccess()) {
+            glCreateBuffers(1, &m_handle);
+            glNamedBufferData(m_handle, static_cast<GLsizeiptr>(frameSize) * FRAMES_IN_FLIGHT, nullptr, GL_STREAM_DRAW);
+            return;
+        }
+
+        glGenBuffers(1, &m_handle);
+        bind();
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(frameSize) * FRAMES_IN_FLIGHT, nullptr, GL_STREAM_DRAW);
+    }
+
+    StreamBuffer::~StreamBuffer() {
+        for (auto& fence : m_fences) {
+            if (fence) glDeleteSync(fence);
+        }
+        GLState::forgetBuffer(m_handle);
+        glDeleteBuffers(1, &m_handle);
+    }
+
+    void StreamBuffer::beginFrame() {
+        m_region = (m_region + 1) % FRAMES_IN_FLIGHT;
+        m_cursor = 0;
+
+        GLsync& fence = m_fences[m_region];
+        if (!fence) return;
+
+        // The region is about to be overwritten, so the GPU has to be done with the frame that last used it. This is
+        // normally already the case, so the first check doesn't wait at all.
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (result == GL_TIMEOUT_EXPIRED) {
+            m_stalls++;
+            do {
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            } while (result == GL_TIMEOUT_EXPIRED);
+        }
+        LOGGER.weakAssert(result != GL_WAIT_FAILED, "Waiting on stream buffer fence failed");
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    void StreamBuffer::endFrame() {
+        if (m_mapped) commit();
+        if (!m_cursor) return;
+        m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    StreamAllocation StreamBuffer::allocate(unsigned int size, unsigned int alignment) {
+        if (m_mapped) commit();
+
+        // Aligned within the whole buffer rather than the region, since draws source data by its absolute offset and
+        // the frame size needn't be a multiple of every alignment asked for.
+        unsigned int base = m_region * m_frameSize;
+        unsigned int offset = (base + m_cursor + alignment - 1) / alignment * alignment;
+        unsigned int start = offset - base;
+        if (!size || start + size > m_frameSize) {
+            LOGGER.warn("Stream buffer region is full ({} + {} > {} bytes)", start, size, m_frameSize);
+            return {};
+        }
+        m_cursor = start + size;
+
+        bind();
+        // Unsynchronised since the fence in beginFrame already guarantees the GPU isn't using this range, and
+        // invalidated so the driver doesn't have to preserve the old contents.
+        void* data = glMapBufferRange(GL_ARRAY_BUFFER, offset, size,
+            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (!data) {
+            LOGGER.warn("Failed to map stream buffer range");
+            return {};
+        }
+        m_mapped = true;
+        // Counted when it is handed out, since whatever it is for is about to be written into it.
+        RG_RENDER_STAT(countBufferBytes(size));
+
+        return { data, offset, size };
+    }
+
+    void StreamBuffer::commit() {
+        if (!m_mapped) return;
+        bind();
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        m_mapped = false;
+    }
+
+    long long StreamBuffer::upload(const void* data, unsigned int size, unsigned int alignment) {
+        StreamAllocation allocation = allocate(size, alignment);
+        if (!allocation) return -1;
+        std::memcpy(allocation.data, data, size);
+        commit();
+        return allocation.offset;
+    }
+
+    void StreamBuffer::bind(GLenum target) {
+        GLState::bindBuffer(target, m_handle);
+    }
+
+}
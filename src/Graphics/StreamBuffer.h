@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+
+#include <glad/gl.h>
+
+namespace EcoSort {
+
+    struct StreamAllocation {
+
+        // Mapped, write-only memory for the allocation. Only valid until StreamBuffer::commit is called.
+        void* data = nullptr;
+        // Offset of the allocation in the buffer, which is what draws should source the data from.
+        unsigned int offset = 0;
+        unsigned int size = 0;
+
+        explicit operator bool() const { return data != nullptr; }
+
+    };
+
+    // One large buffer split into a region per frame in flight, for data that is rewritten every frame. Allocations are
+    // made by bumping a cursor through the current frame's region and are written through unsynchronised maps, so
+    // uploads never reallocate storage or wait on draws that are still reading older data. Each region is fenced when
+    // its frame ends and the fence is only waited on when the region comes around again.
+    class StreamBuffer {
+    public:
+
+        static constexpr unsigned int FRAMES_IN_FLIGHT = 3;
+
+        explicit StreamBuffer(unsigned int frameSize);
+        ~StreamBuffer();
+
+        StreamBuffer(const StreamBuffer&) = delete;
+        StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+        void beginFrame();
+        void endFrame();
+
+        // The offset is a multiple of alignment within the whole buffer. Returns an empty allocation if the frame's
+        // region is full. commit must be called before drawing with it.
+        StreamAllocation allocate(unsigned int size, unsigned int alignment = 16);
+        void commit();
+
+        // Allocate, copy and commit in one go. Returns the offset of the data, or -1 if it didn't fit.
+        long long upload(const void* data, unsigned int size, unsigned int alignment = 16);
+
+        void bind(GLenum target = GL_ARRAY_BUFFER);
+
+        [[nodiscard]] unsigned int getHandle() const { return m_handle; }
+        [[nodiscard]] unsigned int getFrameSize() const { return m_frameSize; }
+        [[nodiscard]] unsigned int getUsed() const { return m_cursor; }
+        // Number of times beginFrame had to wait on the GPU, which means the buffer should have more frames in flight.
+        [[nodiscard]] unsigned int getStalls() const { return m_stalls; }
+
+    private:
+
+        unsigned int m_handle;
+        unsigned int m_frameSize;
+
+        unsigned int m_region = 0;
+        unsigned int m_cursor = 0;
+
+        bool m_mapped = false;
+
+        std::array<GLsync, FRAMES_IN_FLIGHT> m_fences {};
+
+        unsigned int m_stalls = 0;
+
+    };
+
+}
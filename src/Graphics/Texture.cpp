@@ -1,12 +1,24 @@
 #include "Texture.h"
 
 #include "Game.h"
+#include "GLFeatures.h"
+#include "GLState.h"
 #include "stb_image.h"
 #include "glad/gl.h"
 
 namespace EcoSort {
 
     Texture::Texture() : m_handle(0) {
+        // DSA creates the texture as a 2D texture up front, so its parameters can be set without binding it.
+        if (GLFeatures::hasDirectStateAccess()) {
+            glCreateTextures(GL_TEXTURE_2D, 1, &m_handle);
+            glTextureParameteri(m_handle, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTextureParameteri(m_handle, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTextureParameteri(m_handle, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTextureParameteri(m_handle, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            return;
+        }
+
         glGenTextures(1, &m_handle);
 
         bind();
@@ -18,15 +30,16 @@ namespace EcoSort {
     }
 
     Texture::~Texture() {
+        GLState::forgetTexture(m_handle);
         glDeleteTextures(1, &m_handle);
     }
 
     void Texture::bind() {
-        glBindTexture(GL_TEXTURE_2D, m_handle);
+        GLState::bindTexture(m_handle);
     }
 
     void Texture::setUnit(int unit) {
-        glActiveTexture(GL_TEXTURE0 + unit);
+        GLState::activeTexture(unit);
     }
 
     void Texture::setData(const char* path) {
@@ -93,8 +106,68 @@ namespace EcoSort {
 
     void Texture::setData(const void* data, int width, int height, TextureDescriptor descriptor) {
         
-        int internalFormat;
-        int format = GL_RGBA;
+        int internalFormat, format;
+        getFormat(descriptor, internalFormat, format);
+
+        bind();
+
+        glTexImage2D(
+            GL_TEXTURE_2D,
+            0,
+            internalFormat,
+            width,
+            height,
+            0,
+            format,
+            static_cast<GLenum>(descriptor.dataType),
+            data);
+
+        glGenerateMipmap(GL_TEXTURE_2D);
+        
+    }
+
+    void Texture::allocate(int width, int height, TextureDescriptor descriptor) {
+
+        int internalFormat, format;
+        getFormat(descriptor, internalFormat, format);
+
+        bind();
+
+        // Immutable storage needs a sized format, which the fallback in getFormat isn't.
+        if (GLAD_GL_ARB_texture_storage) {
+            if (internalFormat == GL_RGBA) internalFormat = GL_RGBA8;
+            glTexStorage2D(GL_TEXTURE_2D, 1, static_cast<GLenum>(internalFormat), width, height);
+            return;
+        }
+
+        // Without glTexStorage2D the same result comes from allocating the base level and telling OpenGL it is the
+        // only level, so the texture is complete without a mip chain.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexImage2D(
+            GL_TEXTURE_2D,
+            0,
+            internalFormat,
+            width,
+            height,
+            0,
+            format,
+            static_cast<GLenum>(descriptor.dataType),
+            nullptr);
+    }
+
+    void Texture::setSubData(const unsigned char* data, int x, int y, int width, int height) {
+        if (GLFeatures::hasDirectStateAccess()) {
+            glTextureSubImage2D(m_handle, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+            return;
+        }
+
+        bind();
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    }
+
+    void Texture::getFormat(const TextureDescriptor& descriptor, int& internalFormat, int& format) {
+
+        format = GL_RGBA;
 
         switch (descriptor.dataType) {
             case DataType::UNSIGNED_BYTE:
@@ -173,22 +246,6 @@ namespace EcoSort {
                 internalFormat = GL_RGBA;
                 break;
         }
-
-        bind();
-
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            internalFormat,
-            width,
-            height,
-            0,
-            format,
-            static_cast<GLenum>(descriptor.dataType),
-            data);
-
-        glGenerateMipmap(GL_TEXTURE_2D);
-        
     }
     
 }
@@ -38,8 +38,19 @@ namespace EcoSort {
         void setData(int width, int height, TextureDescriptor descriptor) { setData(nullptr, width, height, descriptor); }
         void setData(const void* data, int width, int height, TextureDescriptor descriptor);
 
+        // Allocate a single level of storage without any data or mipmaps, for textures that are only rendered to. The
+        // storage is immutable where GL_ARB_texture_storage is supported, so this can only be called once per texture.
+        void allocate(int width, int height, TextureDescriptor descriptor);
+
+        // Write 8 bit RGBA data to a region of level 0, which must already have storage.
+        void setSubData(const unsigned char* data, int x, int y, int width, int height);
+
+        [[nodiscard]] unsigned int getHandle() const { return m_handle; }
+
     private:
 
+        static void getFormat(const TextureDescriptor& descriptor, int& internalFormat, int& format);
+
         unsigned int m_handle;
 
         friend class Framebuffer;
@@ -0,0 +1,78 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "Game.h"
+#include "stb_image.h"
+
+namespace EcoSort {
+
+    TextureAtlas::TextureAtlas(int width, int height) : m_width(width), m_height(height) {
+        m_texture->allocate(width, height, { TextureType::COLOUR, DataType::UNSIGNED_BYTE, true });
+        // The padding has to be transparent, and new storage could hold anything.
+        std::vector<unsigned char> clear(static_cast<size_t>(width) * height * 4, 0);
+        m_texture->setSubData(clear.data(), 0, 0, width, height);
+
+        std::array<unsigned char, 4 * 4 * 4> white;
+        white.fill(255);
+        m_white = add(white.data(), 4, 4);
+        // Every corner samples the middle of the block, so nothing stretched over it can reach the padding.
+        const glm::vec4& rect = m_white.uvRect;
+        glm::vec2 centre((rect.x + rect.z) * 0.5f, (rect.y + rect.w) * 0.5f);
+        m_white.uvRect = glm::vec4(centre, centre);
+    }
+
+    AtlasRegion TextureAtlas::add(const char* path) {
+        LOGGER.debug("Loading atlas image from path: {}", path);
+        int w, h;
+        // Flipped like every other texture, so uvs work the same either way.
+        stbi_set_flip_vertically_on_load(true);
+        unsigned char* data = stbi_load(path, &w, &h, nullptr, 4);
+        if (!data) {
+            LOGGER.warn("Failed to load atlas image from path: {}\n"
+                "Failure reason: {}", path, stbi_failure_reason());
+            return {};
+        }
+
+        AtlasRegion region = add(data, w, h);
+        if (!region) {
+            LOGGER.warn("No space left in atlas for {} ({}x{}), giving it its own texture", path, w, h);
+            region.texture = std::make_shared<Texture>();
+            region.texture->setData(data, w, h, true);
+        }
+
+        stbi_image_free(data);
+        return region;
+    }
+
+    AtlasRegion TextureAtlas::add(const unsigned char* data, int width, int height) {
+        // Start a new shelf if the image doesn't fit on the end of this one.
+        if (m_shelfX + width + PADDING > m_width) {
+            m_shelfX = 0;
+            m_shelfY += m_shelfHeight;
+            m_shelfHeight = 0;
+        }
+
+        if (width + PADDING > m_width || m_shelfY + height + PADDING > m_height) return {};
+
+        int x = m_shelfX + PADDING,
+            y = m_shelfY + PADDING;
+        m_texture->setSubData(data, x, y, width, height);
+
+        m_shelfX += width + PADDING;
+        m_shelfHeight = std::max(m_shelfHeight, height + PADDING);
+
+        float atlasWidth = static_cast<float>(m_width),
+              atlasHeight = static_cast<float>(m_height);
+        return {
+            m_texture,
+            glm::vec4(
+                static_cast<float>(x) / atlasWidth, static_cast<float>(y) / atlasHeight,
+                static_cast<float>(x + width) / atlasWidth, static_cast<float>(y + height) / atlasHeight
+            )
+        };
+    }
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+
+#include <glm/vec4.hpp>
+
+#include "Texture.h"
+
+namespace EcoSort {
+
+    // A part of a texture, which is how images packed into an atlas are referred to.
+    struct AtlasRegion {
+        std::shared_ptr<Texture> texture;
+        // The normalised texture coordinates of the region's bottom left (xy) and top right (zw) corners.
+        glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+        explicit operator bool() const { return texture != nullptr; }
+    };
+
+    // Packs many small images into one texture, so everything drawn with them can share a single bind and draw call.
+    // Images are placed left to right along shelves as tall as the tallest image on them, which wastes a little space
+    // but is all the GUI needs. There is always a white region, for drawing plain colours from the same texture.
+    //
+    // Images are written into the texture as they are added, so add must be called on a thread with a current context.
+    class TextureAtlas {
+    public:
+
+        // Empty texels kept around each image, so sampling at the edge of a region never picks up its neighbours.
+        static constexpr int PADDING = 2;
+
+        TextureAtlas(int width, int height);
+
+        TextureAtlas(const TextureAtlas&) = delete;
+        TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+        // Load an image the same way as Texture::setData. If there is no space left, the image is given a texture of
+        // its own, which still works but can't be batched with the rest.
+        AtlasRegion add(const char* path);
+        // Returns an empty region if there is no space left.
+        AtlasRegion add(const unsigned char* data, int width, int height);
+
+        [[nodiscard]] const AtlasRegion& getWhite() const { return m_white; }
+        [[nodiscard]] const std::shared_ptr<Texture>& getTexture() const { return m_texture; }
+
+    private:
+
+        std::shared_ptr<Texture> m_texture = std::make_shared<Texture>();
+
+        int m_width,
+            m_height;
+
+        // Where the next image goes on the current shelf, and the shelf's height so far.
+        int m_shelfX = 0,
+            m_shelfY = 0,
+            m_shelfHeight = 0;
+
+        AtlasRegion m_white;
+
+    };
+
+}
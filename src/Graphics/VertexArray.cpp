@@ -1,30 +1,89 @@
 #include "VertexArray.h"
 
+#include <cstdint>
+
+#include "GLState.h"
+
 namespace EcoSort {
 
-    VertexArray::VertexArray() : m_handle(0) {
-        glGenVertexArrays(1, &m_handle);
-    }
+    std::mutex VertexArray::s_orphanMutex;
+    std::vector<VertexArray::Orphan> VertexArray::s_orphans;
 
     VertexArray::~VertexArray() {
+        if (!m_handle) return;
+
+        if (std::this_thread::get_id() != m_thread) {
+            std::lock_guard lock(s_orphanMutex);
+            s_orphans.push_back({ m_thread, m_handle });
+            return;
+        }
+
+        GLState::forgetVertexArray(m_handle);
         glDeleteVertexArrays(1, &m_handle);
     }
 
     void VertexArray::bind() {
-        glBindVertexArray(m_handle);
+        if (!m_handle) {
+            glGenVertexArrays(1, &m_handle);
+            m_thread = std::this_thread::get_id();
+        }
+
+        GLState::bindVertexArray(m_handle);
+
+        if (!m_dirty) return;
+        m_dirty = false;
+
+        for (auto& attribute : m_attributes) {
+            GLState::bindBuffer(GL_ARRAY_BUFFER, attribute.buffer);
+            glVertexAttribPointer(attribute.index,
+                static_cast<GLint>(attribute.elements),
+                static_cast<GLenum>(attribute.type),
+                GL_FALSE,
+                static_cast<GLsizei>(attribute.stride),
+                reinterpret_cast<const void*>(static_cast<uintptr_t>(attribute.offset)));
+            glEnableVertexAttribArray(attribute.index);
+        }
     }
 
     // Set an attribute of tightly packed, self normalised data for the vertex array at index and enable it
-    void VertexArray::setBuffer(unsigned int index, VertexBuffer& vbo, DataType type, DataElements elements) {
-        bind();
-        vbo.bind();
-        glVertexAttribPointer(index,
-            static_cast<GLint>(elements),
-            static_cast<GLenum>(type),
-            GL_FALSE,
-            0,
-            nullptr);
-        glEnableVertexAttribArray(index);
+    void VertexArray::setBuffer(unsigned int index, const std::shared_ptr<VertexBuffer>& vbo, DataType type,
+        DataElements elements) {
+        setAttribute({ index, vbo->getHandle(), type, elements, 0, 0, vbo });
+    }
+
+    // Same as above, but for interleaved data.
+    void VertexArray::setBuffer(unsigned int index, const std::shared_ptr<VertexBuffer>& vbo, DataType type,
+        DataElements elements, unsigned int stride, unsigned int offset) {
+        setAttribute({ index, vbo->getHandle(), type, elements, stride, offset, vbo });
+    }
+
+    // Same as above, but for interleaved data sourced from an allocation in a stream buffer.
+    void VertexArray::setBuffer(unsigned int index, StreamBuffer& buffer, DataType type, DataElements elements,
+        unsigned int stride, unsigned int offset) {
+        setAttribute({ index, buffer.getHandle(), type, elements, stride, offset, nullptr });
+    }
+
+    void VertexArray::collectOrphans() {
+        std::thread::id thread = std::this_thread::get_id();
+
+        std::lock_guard lock(s_orphanMutex);
+        std::erase_if(s_orphans, [&](const Orphan& orphan) {
+            if (orphan.thread != thread) return false;
+            GLState::forgetVertexArray(orphan.handle);
+            glDeleteVertexArrays(1, &orphan.handle);
+            return true;
+        });
+    }
+
+    void VertexArray::setAttribute(const Attribute& attribute) {
+        // Every attribute is set again on the next bind, which is cheap since layouts rarely change after creation.
+        m_dirty = true;
+        for (auto& existing : m_attributes) {
+            if (existing.index != attribute.index) continue;
+            existing = attribute;
+            return;
+        }
+        m_attributes.push_back(attribute);
     }
     
-}
\ No newline at end of file
+}
@@ -1,23 +1,71 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "StreamBuffer.h"
 #include "VertexBuffer.h"
 
 namespace EcoSort {
 
+    // Vertex arrays are the one object used here that contexts can't share, so the GL object isn't created until the
+    // first bind, which is always on the thread that draws with it. Until then setBuffer only records the layout. This
+    // lets meshes be built on a thread with a different (shared) context to the one rendering them.
     class VertexArray {
     public:
 
-        VertexArray();
+        VertexArray() = default;
         ~VertexArray();
 
+        VertexArray(const VertexArray&) = delete;
+        VertexArray& operator=(const VertexArray&) = delete;
+
         void bind();
 
-        void setBuffer(unsigned int index, VertexBuffer& vbo, DataType type, DataElements elements);
+        // The vertex array keeps a reference to vbo, so it is alive for as long as anything might draw with it.
+        void setBuffer(unsigned int index, const std::shared_ptr<VertexBuffer>& vbo, DataType type, DataElements elements);
+        void setBuffer(unsigned int index, const std::shared_ptr<VertexBuffer>& vbo, DataType type, DataElements elements,
+            unsigned int stride, unsigned int offset);
+        void setBuffer(unsigned int index, StreamBuffer& buffer, DataType type, DataElements elements,
+            unsigned int stride, unsigned int offset);
+
+        // 0 until the first bind.
+        [[nodiscard]] unsigned int getHandle() const { return m_handle; }
+
+        // Delete the vertex arrays that were destroyed on a thread other than the one that created them, which can
+        // only be done on the creating thread. Threads that draw should call this once a frame.
+        static void collectOrphans();
 
     private:
 
-        unsigned int m_handle;
+        struct Attribute {
+            unsigned int index;
+            unsigned int buffer;
+            DataType type;
+            DataElements elements;
+            unsigned int stride;
+            unsigned int offset;
+            std::shared_ptr<VertexBuffer> owner;
+        };
+
+        struct Orphan {
+            std::thread::id thread;
+            unsigned int handle;
+        };
+
+        void setAttribute(const Attribute& attribute);
+
+        unsigned int m_handle = 0;
+        std::thread::id m_thread;
+
+        std::vector<Attribute> m_attributes;
+        bool m_dirty = false;
+
+        static std::mutex s_orphanMutex;
+        static std::vector<Orphan> s_orphans;
             
     };
     
-}
\ No newline at end of file
+}
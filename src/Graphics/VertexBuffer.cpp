@@ -1,22 +1,48 @@
 #include "VertexBuffer.h"
 
+#include "GLFeatures.h"
+#include "GLState.h"
+#include "RenderStats.h"
+
 namespace EcoSort {
 
     VertexBuffer::VertexBuffer(DataUsage usage) : m_handle(0), m_usage(usage) {
-        glGenBuffers(1, &m_handle);
+        // With DSA the buffer is created straight away and can be filled without ever being bound.
+        if (GLFeatures::hasDirectStateAccess()) {
+            glCreateBuffers(1, &m_handle);
+        } else {
+            glGenBuffers(1, &m_handle);
+        }
     }
 
     VertexBuffer::~VertexBuffer() {
+        GLState::forgetBuffer(m_handle);
         glDeleteBuffers(1, &m_handle);
     }
 
     void VertexBuffer::bind() {
-        glBindBuffer(GL_ARRAY_BUFFER, m_handle);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, m_handle);
     }
 
     void VertexBuffer::setData(const void* data, unsigned int size, DataUsage usage) {
+        // Allocations without data don't upload anything.
+        if (data) RG_RENDER_STAT(countBufferBytes(size));
+        if (GLFeatures::hasDirectStateAccess()) {
+            glNamedBufferData(m_handle, size, data, static_cast<GLenum>(usage));
+            return;
+        }
         bind();
         glBufferData(GL_ARRAY_BUFFER, size, data, static_cast<GLenum>(usage));
     }
+
+    void VertexBuffer::setSubData(const void* data, unsigned int offset, unsigned int size) {
+        RG_RENDER_STAT(countBufferBytes(size));
+        if (GLFeatures::hasDirectStateAccess()) {
+            glNamedBufferSubData(m_handle, offset, size, data);
+            return;
+        }
+        bind();
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    }
     
 }
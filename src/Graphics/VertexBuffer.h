@@ -36,6 +36,10 @@ namespace EcoSort {
         
         void setData(const void* data, unsigned int size) { setData(data, size, DataUsage::STATIC_DRAW); }
         void setData(const void* data, unsigned int size, DataUsage usage);
+        // Overwrite part of storage already allocated by setData.
+        void setSubData(const void* data, unsigned int offset, unsigned int size);
+
+        [[nodiscard]] unsigned int getHandle() const { return m_handle; }
 
     private:
 
@@ -0,0 +1,133 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include <GLFW/glfw3.h>
+
+#include "Game.h"
+
+namespace EcoSort {
+
+    void FramePacer::release() {
+        for (auto& fence : m_fences) {
+            if (fence) glDeleteSync(fence);
+            fence = nullptr;
+        }
+        m_fenceIndex = 0;
+    }
+
+    void FramePacer::configure(PresentMode mode, double targetRate, unsigned int maxFramesInFlight) {
+        m_mode = mode;
+        m_targetInterval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(targetRate > 0.0 ? 1.0 / targetRate : 0.0));
+        m_maxFramesInFlight = std::clamp(maxFramesInFlight, 1u, MAX_FRAMES_IN_FLIGHT);
+        m_started = false;
+        // Fences past the new count would never be waited on again.
+        release();
+
+        applyPresentMode();
+    }
+
+    void FramePacer::applyPresentMode() const {
+        switch (m_mode) {
+            case PresentMode::VSYNC:
+                glfwSwapInterval(1);
+                break;
+            case PresentMode::ADAPTIVE_VSYNC:
+                // A negative interval is how swap_control_tear is asked for.
+                if (glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+                    glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+                    glfwSwapInterval(-1);
+                } else {
+                    LOGGER.warn("Adaptive vsync is not supported, using vsync instead");
+                    glfwSwapInterval(1);
+                }
+                break;
+            case PresentMode::UNCAPPED:
+            case PresentMode::LIMITED:
+                glfwSwapInterval(0);
+                break;
+        }
+    }
+
+    double FramePacer::beginFrame() {
+        if (m_mode == PresentMode::LIMITED && m_started) {
+            // Frames are scheduled from when the last one should have started, not when it did, so small overshoots
+            // don't build up into a lower rate. If the game has fallen more than a frame behind it starts over from
+            // now rather than rushing through frames to catch up.
+            m_nextFrame += m_targetInterval;
+            if (Clock::now() > m_nextFrame + m_targetInterval) m_nextFrame = Clock::now();
+            waitUntil(m_nextFrame);
+        }
+
+        Clock::time_point now = Clock::now();
+
+        if (!m_started) {
+            m_started = true;
+            m_lastFrame = now;
+            m_nextFrame = now;
+            return 0.0;
+        }
+
+        double interval = std::chrono::duration<double>(now - m_lastFrame).count();
+        m_lastFrame = now;
+
+        m_intervals[m_nextInterval] = interval * 1000.0;
+        m_nextInterval = (m_nextInterval + 1) % HISTORY_SIZE;
+        m_intervalCount = std::min(m_intervalCount + 1, HISTORY_SIZE);
+
+        return interval;
+    }
+
+    void FramePacer::endFrame() {
+        // This slot was fenced maxFramesInFlight frames ago, so once it has signalled this frame and the ones before it
+        // are the only ones the GPU can still be working on.
+        GLsync& fence = m_fences[m_fenceIndex];
+        if (fence) {
+            // Flushing makes sure the fence is actually submitted, or this could wait forever. The timeout is only
+            // there so a lost context can't hang the game.
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000);
+            glDeleteSync(fence);
+        }
+
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_fenceIndex = (m_fenceIndex + 1) % m_maxFramesInFlight;
+    }
+
+    FramePacingStats FramePacer::getStats() const {
+        if (!m_intervalCount) return {};
+
+        std::vector<double> sorted(m_intervals.begin(), m_intervals.begin() + m_intervalCount);
+        std::ranges::sort(sorted);
+
+        FramePacingStats stats;
+        stats.samples = m_intervalCount;
+        stats.min = sorted.front();
+        stats.max = sorted.back();
+
+        double sum = 0.0;
+        for (double interval : sorted) sum += interval;
+        stats.average = sum / m_intervalCount;
+
+        double variance = 0.0;
+        for (double interval : sorted) variance += (interval - stats.average) * (interval - stats.average);
+        stats.jitter = std::sqrt(variance / m_intervalCount);
+
+        unsigned int p99Index = std::min(m_intervalCount - 1, static_cast<unsigned int>(m_intervalCount * 0.99));
+        stats.p99 = sorted[p99Index];
+
+        return stats;
+    }
+
+    void FramePacer::waitUntil(Clock::time_point time) {
+        Clock::time_point sleepUntil = time - SPIN_TIME;
+        if (Clock::now() < sleepUntil) std::this_thread::sleep_until(sleepUntil);
+
+        while (Clock::now() < time) {
+            std::this_thread::yield();
+        }
+    }
+
+}
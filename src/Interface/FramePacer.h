@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include <glad/gl.h>
+
+namespace EcoSort {
+
+    enum class PresentMode {
+        // Wait for vertical blank before presenting.
+        VSYNC,
+        // Like VSYNC, but frames that miss a vertical blank are presented straight away instead of waiting for the
+        // next one. Falls back to VSYNC if the platform doesn't support it.
+        ADAPTIVE_VSYNC,
+        // Present as soon as a frame is done.
+        UNCAPPED,
+        // No vsync, with frames started at a fixed rate by sleeping and then spinning for the last stretch.
+        LIMITED
+    };
+
+    struct FramePacingStats {
+
+        // All times are in milliseconds.
+        double min = 0.0,
+               average = 0.0,
+               max = 0.0,
+               p99 = 0.0,
+               // Standard deviation of the intervals, so 0 is perfectly even pacing.
+               jitter = 0.0;
+
+        unsigned int samples = 0;
+
+    };
+
+    // Decides when frames start and how far the CPU can run ahead of the GPU.
+    //
+    // beginFrame is called by the simulating thread at the start of each frame. It applies the frame limiter and
+    // returns the measured time since the last frame. endFrame is called by the thread with the context after each
+    // frame is submitted. It waits on the fence from maxFramesInFlight frames ago and then fences the frame, so the
+    // driver can't queue up frames and add latency between input and the frame that shows it. The two halves share no
+    // state, so they can be called from different threads.
+    class FramePacer {
+    public:
+
+        static constexpr unsigned int MAX_FRAMES_IN_FLIGHT = 8;
+        // Number of intervals the rolling statistics are computed over.
+        static constexpr unsigned int HISTORY_SIZE = 240;
+
+        FramePacer() = default;
+
+        FramePacer(const FramePacer&) = delete;
+        FramePacer& operator=(const FramePacer&) = delete;
+
+        // targetRate is only used by LIMITED. maxFramesInFlight is clamped to [1, MAX_FRAMES_IN_FLIGHT].
+        void configure(PresentMode mode, double targetRate, unsigned int maxFramesInFlight);
+
+        // Set the swap interval for the mode on the current context.
+        void applyPresentMode() const;
+
+        // Returns the time in seconds since the last call, or 0 on the first.
+        double beginFrame();
+        void endFrame();
+        // Delete the fences, which needs the context they were made on to be current. Window calls this before it
+        // destroys the context, since the pacer outlives it.
+        void release();
+
+        [[nodiscard]] PresentMode getPresentMode() const { return m_mode; }
+        [[nodiscard]] FramePacingStats getStats() const;
+
+    private:
+
+        using Clock = std::chrono::steady_clock;
+
+        // Sleeping is only accurate to a millisecond or so, which is spent spinning instead.
+        static constexpr std::chrono::microseconds SPIN_TIME { 2000 };
+
+        void waitUntil(Clock::time_point time);
+
+        PresentMode m_mode = PresentMode::VSYNC;
+        Clock::duration m_targetInterval {};
+        unsigned int m_maxFramesInFlight = 2;
+
+        // Simulating thread.
+        Clock::time_point m_lastFrame {};
+        Clock::time_point m_nextFrame {};
+        bool m_started = false;
+
+        std::array<double, HISTORY_SIZE> m_intervals {};
+        unsigned int m_intervalCount = 0,
+                     m_nextInterval = 0;
+
+        // Context thread.
+        std::array<GLsync, MAX_FRAMES_IN_FLIGHT> m_fences {};
+        unsigned int m_fenceIndex = 0;
+
+    };
+
+}
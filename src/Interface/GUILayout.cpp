@@ -0,0 +1,140 @@
+#include "GUILayout.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Renderer.h"
+
+namespace EcoSort {
+
+    bool GUILayout::update(Scene& scene, int width, int height) {
+        if (width == m_width && height == m_height && matches(scene)) return false;
+
+        m_width = width;
+        m_height = height;
+        rebuild(scene);
+        return true;
+    }
+
+    void GUILayout::updateHover(float x, float y, bool pressed) {
+        if (m_hoverStale) {
+            for (auto& rect : m_rects) {
+                rect.element->first.isHovered = false;
+                rect.element->first.isClicked = false;
+            }
+            m_hoverStale = false;
+        } else {
+            for (unsigned int index : m_hovered) {
+                m_rects[index].element->first.isHovered = false;
+                m_rects[index].element->first.isClicked = false;
+            }
+        }
+
+        m_hovered.clear();
+        if (m_rects.empty()) return;
+
+        // Every GUI touching the cell is in its list, so only the exact test below decides what is under the point.
+        unsigned int cell = static_cast<unsigned int>(getCell(y, m_cellsY) * m_cellsX + getCell(x, m_cellsX));
+        for (unsigned int i = m_cellOffsets[cell]; i < m_cellOffsets[cell + 1]; i++) {
+            unsigned int index = m_cellRects[i];
+            const GUIRect& rect = m_rects[index];
+
+            glm::vec2 halfSize = rect.size / 2.0f;
+            bool hovered = x >= rect.position.x - halfSize.x && x <= rect.position.x + halfSize.x
+                && y >= rect.position.y - halfSize.y && y <= rect.position.y + halfSize.y;
+            if (!hovered) continue;
+
+            rect.element->first.isHovered = true;
+            rect.element->first.isClicked = pressed;
+            m_hovered.push_back(index);
+        }
+    }
+
+    bool GUILayout::sameTransform(const Transform2DComponent& a, const Transform2DComponent& b) {
+        return a.position.offset == b.position.offset && a.position.scale == b.position.scale
+            && a.size.offset == b.size.offset && a.size.scale == b.size.scale && a.zIndex == b.zIndex;
+    }
+
+    bool GUILayout::matches(Scene& scene) {
+        size_t next = 0;
+        for (auto& [ guiFrame, frameTransform ] : scene.view<GUIFrameComponent, Transform2DComponent>()) {
+            if (next >= m_sources.size() || m_sources[next].element
+                || !sameTransform(m_sources[next].transform, *frameTransform)) return false;
+            next++;
+
+            for (auto& element : guiFrame->guis) {
+                if (next >= m_sources.size() || m_sources[next].element != element.get()
+                    || !sameTransform(m_sources[next].transform, element->second)) return false;
+                next++;
+            }
+        }
+        return next == m_sources.size();
+    }
+
+    void GUILayout::rebuild(Scene& scene) {
+        m_sources.clear();
+        m_rects.clear();
+
+        for (auto& [ guiFrame, frameTransform ] : scene.view<GUIFrameComponent, Transform2DComponent>()) {
+            m_sources.push_back({ nullptr, *frameTransform });
+
+            TransformComponent absoluteFrame = Renderer::getRelativeTransform2D(*frameTransform,
+                { {}, { m_width, m_height, 1 } });
+
+            for (auto& element : guiFrame->guis) {
+                m_sources.push_back({ element.get(), element->second });
+
+                TransformComponent absolute = Renderer::getRelativeTransform2D(element->second, absoluteFrame);
+                m_rects.push_back({
+                    element,
+                    glm::vec2(absolute.position),
+                    glm::vec2(absolute.scale),
+                    absolute.getTransformation()
+                });
+            }
+        }
+
+        buildGrid();
+
+        m_hovered.clear();
+        m_hoverStale = true;
+        m_rebuilds++;
+    }
+
+    void GUILayout::buildGrid() {
+        m_cellsX = std::max((m_width + CELL_SIZE - 1) / CELL_SIZE, 1);
+        m_cellsY = std::max((m_height + CELL_SIZE - 1) / CELL_SIZE, 1);
+
+        // GUIs hanging off the edge of the screen are put in the edge cells, where points off the screen are looked
+        // up, so they can still be hit there.
+        auto forEachCell = [&](const GUIRect& rect, auto&& visit) {
+            glm::vec2 halfSize = rect.size / 2.0f;
+            int minX = getCell(rect.position.x - halfSize.x, m_cellsX),
+                maxX = getCell(rect.position.x + halfSize.x, m_cellsX),
+                minY = getCell(rect.position.y - halfSize.y, m_cellsY),
+                maxY = getCell(rect.position.y + halfSize.y, m_cellsY);
+            for (int y = minY; y <= maxY; y++) {
+                for (int x = minX; x <= maxX; x++) visit(static_cast<unsigned int>(y * m_cellsX + x));
+            }
+        };
+
+        // Counted, turned into offsets, then filled in, so every cell's list is packed into one array.
+        unsigned int cellCount = static_cast<unsigned int>(m_cellsX * m_cellsY);
+        m_cellOffsets.assign(cellCount + 1, 0);
+        for (auto& rect : m_rects) {
+            forEachCell(rect, [&](unsigned int cell) { m_cellOffsets[cell + 1]++; });
+        }
+        for (unsigned int cell = 0; cell < cellCount; cell++) m_cellOffsets[cell + 1] += m_cellOffsets[cell];
+
+        m_cellRects.resize(m_cellOffsets[cellCount]);
+        std::vector<unsigned int> cursors(m_cellOffsets.begin(), m_cellOffsets.end() - 1);
+        for (unsigned int index = 0; index < m_rects.size(); index++) {
+            forEachCell(m_rects[index], [&](unsigned int cell) { m_cellRects[cursors[cell]++] = index; });
+        }
+    }
+
+    int GUILayout::getCell(float position, int cells) const {
+        return std::clamp(static_cast<int>(std::floor(position / CELL_SIZE)), 0, cells - 1);
+    }
+
+}
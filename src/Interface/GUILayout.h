@@ -0,0 +1,90 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+
+#include "Scene/Components.h"
+#include "Scene/Scene.h"
+
+namespace EcoSort {
+
+    using GUIElement = std::pair<GUIComponent, Transform2DComponent>;
+
+    // A GUI's place on screen, worked out from its transform and its frame's.
+    struct GUIRect {
+        std::shared_ptr<GUIElement> element;
+        // Centred on position, in pixels from the top left of the framebuffer.
+        glm::vec2 position,
+                  size;
+        glm::mat4 model;
+    };
+
+    // The absolute rectangles of every GUI in a scene, in the order they are drawn, shared by hit testing and
+    // rendering so they are only worked out once.
+    //
+    // Components are plain data that anything can write to, so there is nothing to tell the layout when one changes.
+    // Instead update compares the transforms it was last built from with the scene's, which is far cheaper than
+    // rebuilding, and only rebuilds when one of them, the GUIs in a frame or the framebuffer size is different.
+    //
+    // Hit testing goes through a grid of CELL_SIZE pixel cells, each listing the GUIs overlapping it, so finding the
+    // GUIs under the mouse only tests the few in its cell however large the menu is.
+    class GUILayout {
+    public:
+
+        static constexpr int CELL_SIZE = 64;
+
+        // Returns true if the layout was rebuilt.
+        bool update(Scene& scene, int width, int height);
+
+        // Set isHovered and isClicked on every GUI in the layout, as if each had been tested against the point. Only
+        // the GUIs that were or are under the point are touched, unless the layout was rebuilt since the last call.
+        void updateHover(float x, float y, bool pressed);
+
+        [[nodiscard]] const std::vector<GUIRect>& getRects() const { return m_rects; }
+        // Number of times the layout has been rebuilt.
+        [[nodiscard]] unsigned long long getRebuilds() const { return m_rebuilds; }
+
+    private:
+
+        // What a layout was built from, in the order it was read from the scene.
+        struct Source {
+            const GUIElement* element;
+            Transform2DComponent transform;
+        };
+
+        static bool sameTransform(const Transform2DComponent& a, const Transform2DComponent& b);
+
+        // Whether the scene's GUIs are laid out exactly as m_sources says.
+        bool matches(Scene& scene);
+        void rebuild(Scene& scene);
+        void buildGrid();
+
+        [[nodiscard]] int getCell(float position, int cells) const;
+
+        int m_width = 0,
+            m_height = 0;
+
+        // A frame's transform is recorded with a null element, followed by its GUIs.
+        std::vector<Source> m_sources;
+        std::vector<GUIRect> m_rects;
+        unsigned long long m_rebuilds = 0;
+
+        int m_cellsX = 0,
+            m_cellsY = 0;
+        // An offset into m_cellRects for each cell, with one more at the end, so cell i's GUIs are between offsets i
+        // and i + 1.
+        std::vector<unsigned int> m_cellOffsets;
+        std::vector<unsigned int> m_cellRects;
+
+        // Indices of the GUIs found under the point by the last updateHover.
+        std::vector<unsigned int> m_hovered;
+        // Set when the layout is rebuilt, so updateHover resets every GUI rather than just m_hovered.
+        bool m_hoverStale = true;
+
+    };
+
+}
@@ -0,0 +1,101 @@
+#include "RenderThread.h"
+
+#include "Graphics/GLState.h"
+#include "Graphics/VertexArray.h"
+
+namespace EcoSort {
+
+    RenderThread::RenderThread(GLFWwindow* window, Renderer& renderer, FramePacer& framePacer, bool present)
+        : m_window(window), m_renderer(renderer), m_framePacer(framePacer), m_present(present),
+          m_thread(&RenderThread::run, this) {}
+
+    RenderThread::~RenderThread() {
+        int pending;
+        while ((pending = m_pending.load()) != NONE) m_pending.wait(pending);
+
+        m_pending = STOP;
+        m_pending.notify_all();
+
+        m_thread.join();
+    }
+
+    void RenderThread::submit(Scene& scene) {
+        int index = m_writeIndex;
+        bool waited = false;
+
+        // This snapshot was submitted two frames ago, so it has already been picked up but may still be drawn from.
+        int rendering;
+        while ((rendering = m_rendering.load()) == index) {
+            waited = true;
+            m_rendering.wait(rendering);
+        }
+
+        m_renderer.record(scene, m_snapshots[index]);
+
+        // Objects created on this thread's context are only guaranteed to be visible to the render thread's once their
+        // commands have been flushed.
+        glFlush();
+
+        // The previous snapshot has to be picked up before this one can take its place.
+        int pending;
+        while ((pending = m_pending.load()) != NONE) {
+            waited = true;
+            m_pending.wait(pending);
+        }
+
+        m_pending = index;
+        m_pending.notify_all();
+
+        m_writeIndex = 1 - index;
+        if (waited) m_waits++;
+    }
+
+    void RenderThread::waitIdle() {
+        // A snapshot is marked as being drawn before it stops being pending, so there is no gap between the two.
+        int pending;
+        while ((pending = m_pending.load()) != NONE) m_pending.wait(pending);
+
+        int rendering;
+        while ((rendering = m_rendering.load()) != NONE) m_rendering.wait(rendering);
+    }
+
+    void RenderThread::run() {
+        glfwMakeContextCurrent(m_window);
+        // The cache on this thread starts empty, but the state the context was left in is unknown.
+        GLState::invalidate();
+        m_framePacer.applyPresentMode();
+
+        while (true) {
+            int index;
+            while ((index = m_pending.load()) == NONE) m_pending.wait(NONE);
+            if (index == STOP) break;
+
+            // Mark the snapshot as being drawn before freeing up the pending slot, so the submitting thread never sees
+            // it as neither and starts recording over it.
+            m_rendering = index;
+            m_pending = NONE;
+            m_pending.notify_all();
+
+            VertexArray::collectOrphans();
+            // The other thread can delete textures and buffers, and new objects can then be given the same names, so
+            // nothing cached from the last frame can be trusted.
+            GLState::invalidate();
+
+            if (m_present) {
+                m_renderer.render(m_snapshots[index], nullptr);
+                glfwSwapBuffers(m_window);
+            } else {
+                m_renderer.render(m_snapshots[index]);
+            }
+
+            m_framePacer.endFrame();
+
+            m_rendering = NONE;
+            m_rendering.notify_all();
+        }
+
+        // Hand the context back so it can be made current on the main thread again.
+        glfwMakeContextCurrent(nullptr);
+    }
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+#include <GLFW/glfw3.h>
+
+#include "FramePacer.h"
+#include "Graphics/RenderCommands.h"
+#include "Renderer.h"
+
+namespace EcoSort {
+
+    // Draws frames on a thread of its own, so the thread submitting them can simulate the next frame while the last
+    // one is rendered and waits on vsync. Frames are handed over as snapshots recorded by Renderer::record, of which
+    // there are two: one being drawn, and one being recorded or waiting to be drawn. The handoff is done with two
+    // atomics and no locks, and submit only blocks when the render thread is a whole frame behind.
+    class RenderThread {
+    public:
+
+        // Takes over window's context, which must not be current on any other thread. Frames are only presented to the
+        // window if present is true.
+        RenderThread(GLFWwindow* window, Renderer& renderer, FramePacer& framePacer, bool present);
+        ~RenderThread();
+
+        RenderThread(const RenderThread&) = delete;
+        RenderThread& operator=(const RenderThread&) = delete;
+
+        // Record the scene into the free snapshot and hand it to the render thread. Anything the snapshot uses that was
+        // created on this thread must have been created with a context that shares objects with window's.
+        void submit(Scene& scene);
+
+        // Wait until every submitted snapshot has been drawn, after which the render thread isn't touching anything
+        // until the next submit.
+        void waitIdle();
+
+        // Number of times submit had to wait for the render thread to catch up.
+        [[nodiscard]] unsigned long long getWaits() const { return m_waits; }
+
+    private:
+
+        static constexpr int NONE = -1,
+                             STOP = -2;
+
+        void run();
+
+        GLFWwindow* m_window;
+        Renderer& m_renderer;
+        FramePacer& m_framePacer;
+        bool m_present;
+
+        std::array<CommandList, 2> m_snapshots;
+        // Only used by the submitting thread.
+        int m_writeIndex = 0;
+
+        // The snapshot that has been submitted but not yet picked up, or STOP to end the thread.
+        std::atomic<int> m_pending = NONE;
+        // The snapshot being drawn.
+        std::atomic<int> m_rendering = NONE;
+
+        unsigned long long m_waits = 0;
+
+        std::thread m_thread;
+
+    };
+
+}
@@ -1,8 +1,18 @@
 #include "Renderer.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
 #include "AssetFetcher.h"
 #include "Game.h"
+#include "Graphics/GLFeatures.h"
+#include "Graphics/GLState.h"
 #include "Graphics/Mesh.h"
+#include "Graphics/ProgramBuilder.h"
+#include "Graphics/ProgramCache.h"
+#include "Graphics/RenderStats.h"
 #include "Scene/Components.h"
 
 #include "glm/ext/matrix_clip_space.hpp"
@@ -13,9 +23,11 @@
 namespace EcoSort {
 
     Renderer::Renderer(int width, int height)
-        : m_width(width), m_height(height), m_geometryTarget(width, height),
-          m_lightingTarget(width, height), m_guiTarget(width, height),
-          m_finalTarget(width, height) {
+        : m_width(width), m_height(height), m_frameWidth(width), m_frameHeight(height),
+          m_targetWidth(width), m_targetHeight(height),
+          m_geometryTarget(width, height),
+          m_lightingTarget(width, height), m_reducedLightingTarget(width, height), m_guiTarget(width, height),
+          m_finalTarget(width, height), m_streamBuffer(4 * 1024 * 1024) {
 
         m_geometryTarget.addAttachment({
             TextureType::COLOUR, DataType::FLOAT, false
@@ -34,6 +46,10 @@ namespace EcoSort {
             TextureType::COLOUR, DataType::UNSIGNED_BYTE, true
         }); // lightingTexture
 
+        m_reducedLightingTarget.addAttachment({
+            TextureType::COLOUR, DataType::UNSIGNED_BYTE, true
+        }); // reducedLightingTexture
+
         m_guiTarget.addAttachment({
         TextureType::COLOUR, DataType::UNSIGNED_BYTE, true
         }); // guiTexture
@@ -48,300 +64,901 @@ namespace EcoSort {
             TextureType::DEPTH, DataType::FLOAT, false
         }); // finalDepth
 
-        // These can be safely marked for deletion once linked to the shader program.
-        Shader gBufferVertShader("res/Shaders/Scene/Deferred/gbuffer.vert", ShaderType::VERT),
-               gBufferFragShader("res/Shaders/Scene/Deferred/gbuffer.frag", ShaderType::FRAG),
-        
-               lightingVertShader("res/Shaders/Scene/Deferred/lighting.vert", ShaderType::VERT),
-               lightingFragShader("res/Shaders/Scene/Deferred/lighting.frag", ShaderType::FRAG),
-
-               guiVertShader("res/Shaders/GUI/gui.vert", ShaderType::VERT),
-               guiFragShader("res/Shaders/GUI/gui.frag", ShaderType::FRAG),
-        
-               finalVertShader("res/Shaders/Scene/Deferred/final.vert", ShaderType::VERT),
-               finalFragShader("res/Shaders/Scene/Deferred/final.frag", ShaderType::FRAG),
-
-               debugLightVertShader("res/Shaders/Debug/showlights.vert", ShaderType::VERT),
-               debugLightFragShader("res/Shaders/Debug/showlights.frag", ShaderType::FRAG);
+        double shaderStartTime = glfwGetTime();
 
-        m_geometryProgram.attachShader(gBufferVertShader);
-        m_geometryProgram.attachShader(gBufferFragShader);
+        // All programs are built in one batch so their shaders compile concurrently.
+        ProgramBuilder programBuilder;
+        programBuilder.add(m_geometryProgram, "res/Shaders/Scene/Deferred/gbuffer.vert", "res/Shaders/Scene/Deferred/gbuffer.frag");
+        if (GLFeatures::hasMultiDrawIndirect()) {
+            // Shares the geometry program's fragment shader, so both paths fill the G-buffer identically.
+            programBuilder.add(m_geometryIndirectProgram,
+                "res/Shaders/Scene/Deferred/Indirect/gbuffer.vert", "res/Shaders/Scene/Deferred/gbuffer.frag");
+        }
+        // Same order as LightComponent::LightType, followed by ambient.
+        const char* lightingPermutations[] = { "LIGHT_POINT", "LIGHT_SPOT", "LIGHT_DIRECTIONAL", "LIGHT_AMBIENT" };
+        for (int i = 0; i < m_lightingPrograms.size(); i++) {
+            programBuilder.add(m_lightingPrograms[i],
+                "res/Shaders/Scene/Deferred/lighting.vert", "res/Shaders/Scene/Deferred/Lighting/lighting.frag",
+                { lightingPermutations[i] });
+        }
+        programBuilder.add(m_guiProgram, "res/Shaders/GUI/Batched/gui.vert", "res/Shaders/GUI/Batched/gui.frag");
+        // The pre-pass uses the same vertex shaders as the geometry pass, so both compute the same depth.
+        programBuilder.add(m_depthProgram,
+            "res/Shaders/Scene/Deferred/gbuffer.vert", "res/Shaders/Scene/Deferred/Depth/depth.frag");
+        if (GLFeatures::hasMultiDrawIndirect()) {
+            programBuilder.add(m_depthIndirectProgram,
+                "res/Shaders/Scene/Deferred/Indirect/gbuffer.vert", "res/Shaders/Scene/Deferred/Depth/depth.frag");
+        }
+        programBuilder.add(m_forwardProgram,
+            "res/Shaders/Scene/Forward/forward.vert", "res/Shaders/Scene/Forward/forward.frag");
+        programBuilder.add(m_forwardDepthProgram,
+            "res/Shaders/Scene/Forward/forward.vert", "res/Shaders/Scene/Deferred/Depth/depth.frag");
+        if (GLFeatures::hasMultiDrawIndirect()) {
+            programBuilder.add(m_forwardIndirectProgram,
+                "res/Shaders/Scene/Deferred/Indirect/gbuffer.vert", "res/Shaders/Scene/Forward/forward.frag");
+        }
+        programBuilder.add(m_upsampleProgram,
+            "res/Shaders/Scene/Deferred/lighting.vert", "res/Shaders/Scene/Deferred/Lighting/upsample.frag");
+        programBuilder.add(m_finalProgram, "res/Shaders/Scene/Deferred/final.vert", "res/Shaders/Scene/Deferred/Final/final.frag");
+        programBuilder.add(m_debugLightProgram, "res/Shaders/Debug/showlights.vert", "res/Shaders/Debug/showlights.frag");
+        programBuilder.build();
+
+        // The indirect vertex shader is linked against fragment shaders written for the GL 4.1 one, so if their
+        // interfaces ever drift apart the indirect path is dropped rather than drawing nothing.
+        if (GLFeatures::hasMultiDrawIndirect() && !(m_geometryIndirectProgram.isLinked() &&
+            m_depthIndirectProgram.isLinked() && m_forwardIndirectProgram.isLinked())) {
+            LOGGER.warn("Indirect programs failed to link, using the GL 4.1 path");
+            GLFeatures::disableMultiDrawIndirect();
+        }
 
-        m_lightingProgram.attachShader(lightingVertShader);
-        m_lightingProgram.attachShader(lightingFragShader);
+        // The first run after a shader or driver change compiles everything (cold), later runs load binaries (warm).
+        LOGGER.info("Built shader programs in {:.2f}ms ({} from cache, {} compiled)",
+            (glfwGetTime() - shaderStartTime) * 1000.0, ProgramCache::getHits(), ProgramCache::getMisses());
 
-        m_guiProgram.attachShader(guiVertShader);
-        m_guiProgram.attachShader(guiFragShader);
+        m_geometryProgram.setInt("u_primaryTexture", 0);
 
-        m_finalProgram.attachShader(finalVertShader);
-        m_finalProgram.attachShader(finalFragShader);
+        if (GLFeatures::hasMultiDrawIndirect()) {
+            m_geometryIndirectProgram.setInt("u_primaryTexture", 0);
+            glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &m_storageAlignment);
+        }
 
-        m_debugLightProgram.attachShader(debugLightVertShader);
-        m_debugLightProgram.attachShader(debugLightFragShader);
+        // The same units LightGrid::use is given.
+        ShaderProgram* forwardPrograms[] = {
+            &m_forwardProgram, GLFeatures::hasMultiDrawIndirect() ? &m_forwardIndirectProgram : nullptr
+        };
+        for (ShaderProgram* forwardProgram : forwardPrograms) {
+            if (!forwardProgram) continue;
+            forwardProgram->setInt("u_primaryTexture", 0);
+            forwardProgram->setInt("u_lights", 1);
+            forwardProgram->setInt("u_tiles", 2);
+            forwardProgram->setInt("u_tileSize", LightGrid::TILE_SIZE);
+        }
 
-        m_geometryProgram.setInt("u_primaryTexture", 0);
+        for (auto& lightingProgram : m_lightingPrograms) {
+            // The ambient permutation only reads albedo, so the other samplers are compiled out of it.
+            if (&lightingProgram != &m_lightingPrograms[AMBIENT_LIGHTING]) {
+                lightingProgram.setInt("u_gPositions", 0);
+                lightingProgram.setInt("u_gNormals", 1);
+            }
+            lightingProgram.setInt("u_gAlbedos", 2);
+            lightingProgram.setInt("u_lightingScale", m_appliedLightingScale);
+        }
 
-        m_lightingProgram.setInt("u_gPositions", 0);
-        m_lightingProgram.setInt("u_gNormals", 1);
-        m_lightingProgram.setInt("u_gAlbedos", 2);
+        // The G-buffer takes units 0 to 3, with the reduced lighting after it.
+        m_upsampleProgram.setInt("u_gNormals", 1);
+        m_upsampleProgram.setInt("u_gDepth", 3);
+        m_upsampleProgram.setInt("u_lighting", 4);
 
         m_guiProgram.setInt("u_image", 0);
 
         m_finalProgram.setInt("u_screen", 0);
 
         m_screenMesh = *AssetFetcher::meshFromPath("res/Models/Fullscreen.obj");
-        m_guiQuad = *AssetFetcher::meshFromPath("res/Models/GUIQuad.obj");
         m_debugLightMesh = *AssetFetcher::meshFromPath("res/Models/Cube.obj");
 
-        m_whiteTexture.setData("res/Textures/white.png");
+        // GUI quads are written straight into the stream buffer, and drawn from wherever they were allocated.
+        m_guiVertexArray.setBuffer(0, m_streamBuffer, DataType::FLOAT, DataElements::THREE, sizeof(GUIVertex),
+            offsetof(GUIVertex, position));
+        m_guiVertexArray.setBuffer(1, m_streamBuffer, DataType::FLOAT, DataElements::TWO, sizeof(GUIVertex),
+            offsetof(GUIVertex, uv));
+        m_guiVertexArray.setBuffer(2, m_streamBuffer, DataType::FLOAT, DataElements::FOUR, sizeof(GUIVertex),
+            offsetof(GUIVertex, colour));
 
-        glClearColor(0, 0, 0, 1);
+        // Made here, on the rendering thread, rather than wherever the first GUI happens to be recorded.
+        AssetFetcher::getGUIAtlas();
+
+        GLState::clearColor(0, 0, 0, 1);
 
         // Tell OpenGL to only call the fragment shader for front faces, decided
         // by the winding of their vertices
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
+        GLState::frontFace(GL_CCW);
 
         // Enable depth testing so that the fragment shader is not called for
         // fragments that are behind other fragments.
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
-
-        glfwSwapInterval(1);
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(GL_LESS);
         
     }
 
     void Renderer::resize(int width, int height) {
         m_width = width;
         m_height = height;
-        
+    }
+
+    void Renderer::setLightingScale(int scale) {
+        if (scale != 1 && scale != 2 && scale != 4) {
+            LOGGER.warn("Lighting scale must be 1, 2 or 4, not {}", scale);
+            return;
+        }
+        m_lightingScale = scale;
+    }
+
+    void Renderer::resizeTargets(int width, int height) {
+        m_targetWidth = width;
+        m_targetHeight = height;
+
         m_geometryTarget.resize(width, height);
         m_lightingTarget.resize(width, height);
+        m_guiTarget.resize(width, height);
         m_finalTarget.resize(width, height);
     }
+
+    void Renderer::settleTargets(int width, int height) {
+        // A minimised window reports a zero size, there is nothing worth reallocating for.
+        if (width <= 0 || height <= 0) return;
+
+        if (width == m_targetWidth && height == m_targetHeight) {
+            m_resizeFrames = 0;
+            return;
+        }
+
+        // Dragging a window edge changes the size nearly every frame, so only follow it once it has stopped moving.
+        // Until then the targets keep their old size and the final blit stretches them over the window.
+        if (width != m_pendingWidth || height != m_pendingHeight) {
+            m_pendingWidth = width;
+            m_pendingHeight = height;
+            m_resizeFrames = 0;
+        }
+
+        if (++m_resizeFrames < RESIZE_SETTLE_FRAMES) return;
+
+        m_resizeFrames = 0;
+        resizeTargets(width, height);
+    }
+
+    void Renderer::renderScene(Scene& scene) {
+        record(scene, m_commands);
+        render(m_commands);
+    }
     
     void Renderer::renderScene(Scene& scene, RenderTarget* renderTarget) {
+        record(scene, m_commands);
+        render(m_commands, renderTarget);
+    }
+
+    void Renderer::render(const CommandList& commands, RenderTarget* renderTarget) {
+        render(commands);
+        blit(m_finalTarget, renderTarget);
+    }
+
+    void Renderer::render(const CommandList& commands) {
+
+        m_frameWidth = commands.width;
+        m_frameHeight = commands.height;
+        settleTargets(commands.width, commands.height);
+
+        if (!commands.hasCamera) {
+            LOGGER.warn("No camera found in the scene!");
+            return;
+        }
+
+        m_gpuTimer.beginFrame();
+        RG_RENDER_STAT(beginFrame());
+        m_streamBuffer.beginFrame();
+
+        const CameraCommand& camera = commands.camera;
+
+        auto projection = glm::perspective(camera.fov, 
+            static_cast<float>(m_frameWidth) / static_cast<float>(m_frameHeight),
+            NEAR_PLANE, FAR_PLANE);
+        auto view = glm::mat4_cast(glm::conjugate(camera.rotation))
+            * glm::translate(glm::mat4(1.0f), -camera.position);
+
+        // The per-draw data is written once and shared by every pass that draws the meshes.
+        bool indirect = GLFeatures::hasMultiDrawIndirect() && uploadIndirect(commands.meshes);
+
+        // Falls back to deferred for the frame if the light lists don't fit.
+        bool forwardPlus = useForwardPlus(commands)
+            && m_lightGrid.build(commands.lights, projection, view, m_targetWidth, m_targetHeight);
+
+        if (forwardPlus) {
+            m_forwardPlusFrames++;
+            renderForwardPlus(commands, projection, view, indirect);
+        } else {
+            m_deferredFrames++;
+            renderDeferred(commands, projection, view, indirect);
+        }
+
+        // GUI PASS ----------------------------------------------------------|>
+
+        // The GUI target keeps what was drawn into it between frames, so it is only redrawn where the GUI has changed,
+        // and not at all for a menu that is sitting still.
+        std::array<int, 4> guiRegion {};
+        GUIRedraw guiRedraw = getGUIRedraw(commands.guis, guiRegion);
+        m_guiRedrawCounts[static_cast<int>(guiRedraw)]++;
+
+        if (guiRedraw != GUIRedraw::NONE) {
+
+            m_gpuTimer.begin("GUI");
+
+            GLState::enable(GL_DEPTH_TEST);
+            GLState::enable(GL_BLEND);
+            GLState::disable(GL_CULL_FACE);
+            GLState::blendEquation(GL_FUNC_ADD);
+            GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+            GLState::clearColor(0, 0, 0, 0);
+
+            m_guiTarget.bind();
+
+            // The clear and every draw are clipped to the changed region, and every quad is drawn again so the ones
+            // overlapping it are redrawn in the same order as before.
+            if (guiRedraw == GUIRedraw::PARTIAL) {
+                GLState::enable(GL_SCISSOR_TEST);
+                GLState::scissor(guiRegion[0], guiRegion[1], guiRegion[2], guiRegion[3]);
+            }
+
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            m_guiProgram.use();
+
+            auto guiProjection = glm::ortho(
+                0.0f, static_cast<float>(m_frameWidth),
+                static_cast<float>(m_frameHeight), 0.0f,
+                0.0f, 100.0f
+                );
+
+            m_guiProgram.setMat4("u_projection", glm::value_ptr(guiProjection));
+
+            m_retainedGUI.valid = drawGUI(commands.guis);
+            m_retainedGUI.guis = commands.guis;
+            m_retainedGUI.frameWidth = m_frameWidth;
+            m_retainedGUI.frameHeight = m_frameHeight;
+            m_retainedGUI.targetWidth = m_targetWidth;
+            m_retainedGUI.targetHeight = m_targetHeight;
+            m_retainedGUI.targetAllocations = m_guiTarget.getAllocations();
+
+            GLState::disable(GL_SCISSOR_TEST);
+            GLState::disable(GL_DEPTH_TEST);
+            GLState::disable(GL_BLEND);
+            GLState::enable(GL_CULL_FACE);
+
+            GLState::clearColor(0, 0, 0, 1);
+
+            m_gpuTimer.end();
+
+        }
+
+        // FINAL PASS --------------------------------------------------------|>
+
+        m_gpuTimer.begin("Final");
+
+        GLState::enable(GL_BLEND);
+        GLState::blendEquation(GL_FUNC_ADD);
+        GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        
+        m_finalTarget.bind();
+        m_finalProgram.use();
+
+        // The Forward+ path has already shaded the scene into the final target.
+        if (!forwardPlus) {
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            m_lightingTarget.use();
+            m_screenMesh.draw();
+        }
+
+#ifdef RG_DEBUG_SHOW_LIGHTS
+
+        // DEBUG LIGHTS SUBPASS ----------------------------------------------|>
+
+        m_gpuTimer.begin("DebugLights");
+
+        GLState::enable(GL_DEPTH_TEST);
+
+        // The Forward+ path drew its depth into the final target already.
+        if (!forwardPlus) {
+            GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, m_geometryTarget.m_framebuffer.m_handle);
+            GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, m_finalTarget.m_framebuffer.m_handle);
+
+            glBlitFramebuffer(
+                0, 0, m_targetWidth, m_targetHeight,
+                0, 0, m_targetWidth, m_targetHeight,
+                GL_DEPTH_BUFFER_BIT,
+                GL_NEAREST
+                );
+        }
+        
+        m_finalTarget.bind();
+
+        m_debugLightProgram.use();
+
+        m_debugLightProgram.setMat4("u_projection", glm::value_ptr(projection));
+        m_debugLightProgram.setMat4("u_view", glm::value_ptr(view));
+
+        for (auto& command : commands.lights) {
+
+            TransformComponent transform;
+            transform.position = command.position;
+            transform.rotation = command.rotation;
+            transform.scale = glm::vec3(0.1f);
+            if (command.type == LightComponent::LightType::DIRECTIONAL)
+                transform.scale.y *= 3.0f;
+
+            auto model = transform.getTransformation();
+            m_debugLightProgram.setMat4("u_model", glm::value_ptr(model));
+
+            m_debugLightProgram.setFloats("u_lightColour", glm::value_ptr(command.colour), 3);
+
+            m_debugLightMesh.draw();
+            
+        }
+
+        GLState::disable(GL_DEPTH_TEST);
+
+        m_gpuTimer.end();
+        
+#endif
+
+        m_finalProgram.use();
+
+        m_guiTarget.use();
+        m_screenMesh.draw();
+
+        GLState::disable(GL_BLEND);
+
+        m_gpuTimer.end();
+
+        m_frameCapture.capture(m_finalTarget.m_framebuffer.m_handle, m_targetWidth, m_targetHeight);
+
+        m_streamBuffer.endFrame();
+        AssetFetcher::getMeshHeap().endFrame();
+        
+    }
+
+    bool Renderer::useForwardPlus(const CommandList& commands) const {
+        switch (commands.renderPath) {
+            case RenderPath::DEFERRED:
+                return false;
+            case RenderPath::FORWARD_PLUS:
+                return true;
+            default:
+                break;
+        }
+
+        // Lighting at a reduced resolution needs the G-buffer to upsample with, so asking for it means deferred.
+        if (commands.lightingScale > 1) return false;
+
+        unsigned long long pixels = static_cast<unsigned long long>(m_targetWidth) * m_targetHeight;
+        return commands.lights.size() * pixels <= FORWARD_PLUS_LIGHT_PIXELS;
+    }
+
+    void Renderer::renderDeferred(const CommandList& commands, const glm::mat4& projection, const glm::mat4& view,
+        bool indirect) {
 
         // GEOMETRY PASS -----------------------------------------------------|>
 
-        glEnable(GL_DEPTH_TEST);
+        GLState::enable(GL_DEPTH_TEST);
 
         m_geometryTarget.bind();
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        m_geometryProgram.use();
+        bool prePass = m_overdrawEstimator.beginFrame(commands.sceneID, commands.depthPrePass);
 
-        CameraComponent* camera = nullptr;
-        TransformComponent* cameraTransform = nullptr;
+        if (prePass) {
 
-        for (auto& [ cameraComp, cameraTransformComp ] : scene.findAll<CameraComponent, TransformComponent>()) {
-            camera = cameraComp;
-            cameraTransform = cameraTransformComp;
-            break;
-        }
+            // DEPTH PRE-PASS ------------------------------------------------|>
 
-        if (!camera || !cameraTransform) {
-            LOGGER.warn("No camera found in the scene!");
-            return;
-        }
+            m_gpuTimer.begin("DepthPrePass");
+            m_overdrawEstimator.beginPrePass();
 
-        auto projection = glm::perspective(camera->fov, 
-            static_cast<float>(m_width) / static_cast<float>(m_height),
-            0.1f, 10000.0f);
-        auto view = glm::mat4_cast(glm::conjugate(cameraTransform->rotation))
-            * glm::translate(glm::mat4(1.0f), -cameraTransform->position);
+            GLState::colorMask(false);
+            drawGeometry(commands.meshes, m_depthProgram, m_depthIndirectProgram, indirect, projection, view);
+            GLState::colorMask(true);
 
-        m_geometryProgram.setMat4("u_projection", glm::value_ptr(projection));
-        m_geometryProgram.setMat4("u_view", glm::value_ptr(view));
+            // The depth buffer now holds the nearest surface of every pixel, so only the fragment that matches it
+            // is shaded in the geometry pass and nothing hidden writes to the G-buffer. GL 4.1's gbuffer.vert doesn't
+            // declare gl_Position invariant, so the two programs aren't guaranteed to compute exactly the same depth,
+            // and GL_LEQUAL also passes where the geometry pass lands in front of the pre-pass.
+            GLState::depthFunc(GL_LEQUAL);
+            GLState::depthMask(false);
 
-        for (auto& [ mesh, transform ] : scene.findAll<Mesh, TransformComponent>()) {
+            m_overdrawEstimator.endPrePass();
+            m_gpuTimer.end();
+
+        }
 
-            auto model = transform->getTransformation();
-            m_geometryProgram.setMat4("u_model", glm::value_ptr(model));
+        // Timed separately with and without the pre-pass, so the two can be compared.
+        m_gpuTimer.begin(prePass ? "GeometryAfterPrePass" : "Geometry");
+        m_overdrawEstimator.beginGeometry();
 
-            auto normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
-            m_geometryProgram.setMat3("u_normalMatrix", glm::value_ptr(normalMatrix));
+        drawGeometry(commands.meshes, m_geometryProgram, m_geometryIndirectProgram, indirect, projection, view);
 
-            mesh->draw();
+        m_overdrawEstimator.endGeometry();
+        m_gpuTimer.end();
+
+        if (prePass) {
+            GLState::depthFunc(GL_LESS);
+            GLState::depthMask(true);
         }
 
-        glDisable(GL_DEPTH_TEST);
+        GLState::disable(GL_DEPTH_TEST);
 
         // LIGHTING PASS -----------------------------------------------------|>
 
-        glEnable(GL_BLEND);
-        glBlendEquation(GL_FUNC_ADD);
-        glBlendFunc(GL_ONE, GL_ONE);
+        m_gpuTimer.begin("Lighting");
 
-        m_lightingTarget.bind();
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        GLState::enable(GL_BLEND);
+        GLState::blendEquation(GL_FUNC_ADD);
+        GLState::blendFunc(GL_ONE, GL_ONE);
+
+        int lightingScale = commands.lightingScale;
+        if (lightingScale != m_appliedLightingScale) {
+            m_appliedLightingScale = lightingScale;
+            for (auto& lightingProgram : m_lightingPrograms) {
+                lightingProgram.setInt("u_lightingScale", lightingScale);
+            }
+        }
+
+        // Rounded up, so the reduced pixels cover every full resolution pixel.
+        int lightingWidth = (m_targetWidth + lightingScale - 1) / lightingScale;
+        int lightingHeight = (m_targetHeight + lightingScale - 1) / lightingScale;
 
-        m_lightingProgram.use();
+        RenderTarget& lightingTarget = lightingScale > 1 ? m_reducedLightingTarget : m_lightingTarget;
+        // Only ever changes the viewport, unless the reduced target has never been used at this size before.
+        if (lightingScale > 1) m_reducedLightingTarget.resize(lightingWidth, lightingHeight);
+
+        lightingTarget.bind();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         m_geometryTarget.use();
 
-        m_lightingProgram.setInt("u_light.lightType", 4);
+        m_lightingPrograms[AMBIENT_LIGHTING].use();
 
         m_screenMesh.draw();
 
-        for (auto& [ light, transform ] : scene.findAll<LightComponent, TransformComponent>()) {
+        for (auto& command : commands.lights) {
 
-            m_lightingProgram.setInt("u_light.lightType", static_cast<int>(light->type));
-            m_lightingProgram.setFloats("u_light.position", glm::value_ptr(transform->position), 3);
-            
-            auto defaultLightDirection = glm::vec3(0.0f, 0.0f, -1.0f);
-            auto dir = transform->rotation * defaultLightDirection;
-            
-            m_lightingProgram.setFloats("u_light.direction", glm::value_ptr(dir), 3);
-            m_lightingProgram.setFloats("u_light.colour", glm::value_ptr(light->colour), 3);
-            m_lightingProgram.setFloat("u_light.distance", light->distance);
+            ShaderProgram& lightingProgram = m_lightingPrograms[static_cast<int>(command.type)];
+            lightingProgram.use();
+
+            // Each permutation only has the uniforms its light type uses, the rest are compiled out.
+            if (command.type != LightComponent::LightType::DIRECTIONAL) {
+                lightingProgram.setFloats("u_light.position", glm::value_ptr(command.position), 3);
+                lightingProgram.setFloat("u_light.distance", command.distance);
+            }
+
+            if (command.type != LightComponent::LightType::POINT) {
+                lightingProgram.setFloats("u_light.direction", glm::value_ptr(command.direction), 3);
+            }
+
+            lightingProgram.setFloats("u_light.colour", glm::value_ptr(command.colour), 3);
             
             m_screenMesh.draw();
             
         }
 
-        glDisable(GL_BLEND);
+        GLState::disable(GL_BLEND);
 
-        // GUI PASS ----------------------------------------------------------|>
+        m_gpuTimer.end();
+
+        // UPSAMPLE PASS -----------------------------------------------------|>
+
+        if (lightingScale > 1) {
+
+            m_gpuTimer.begin("Upsample");
+
+            m_lightingTarget.bind();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            m_upsampleProgram.use();
+            m_upsampleProgram.setInt("u_lightingScale", lightingScale);
+            m_upsampleProgram.setInts("u_lightingSize", std::array { lightingWidth, lightingHeight }.data(), 2);
+            m_upsampleProgram.setInts("u_size", std::array { m_targetWidth, m_targetHeight }.data(), 2);
+            m_upsampleProgram.setFloat("u_near", NEAR_PLANE);
+            m_upsampleProgram.setFloat("u_far", FAR_PLANE);
+
+            m_geometryTarget.use();
+            m_reducedLightingTarget.use(4);
+
+            m_screenMesh.draw();
+
+            m_gpuTimer.end();
+
+        }
+
+    }
+
+    void Renderer::renderForwardPlus(const CommandList& commands, const glm::mat4& projection, const glm::mat4& view,
+        bool indirect) {
+
+        // DEPTH PRE-PASS ----------------------------------------------------|>
 
-        glEnable(GL_DEPTH_TEST);
-        glEnable(GL_BLEND);
-        glDisable(GL_CULL_FACE);
-        glBlendEquation(GL_FUNC_ADD);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        m_gpuTimer.begin("ForwardDepthPrePass");
 
-        glClearColor(0, 0, 0, 0);
+        GLState::enable(GL_DEPTH_TEST);
 
-        m_guiTarget.bind();
+        m_finalTarget.bind();
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        m_guiProgram.use();
+        // Shading loops over every light in the tile, so it is only worth doing once per pixel.
+        GLState::colorMask(false);
+        drawGeometry(commands.meshes, m_forwardDepthProgram, m_depthIndirectProgram, indirect, projection, view);
+        GLState::colorMask(true);
 
-        auto guiProjection = glm::ortho(
-            0.0f, static_cast<float>(m_width),
-            static_cast<float>(m_height), 0.0f,
-            0.0f, 100.0f
-            );
+        m_gpuTimer.end();
 
-        m_guiProgram.setMat4("u_projection", glm::value_ptr(guiProjection));
+        // SHADING PASS ------------------------------------------------------|>
 
-        for (auto& [ gui, transform ] : scene.findAll<GUIFrameComponent, Transform2DComponent>()) {
+        m_gpuTimer.begin("ForwardShading");
 
-            TransformComponent scaledTransform = getAbsoluteTransform2D(*transform);
+        GLState::depthFunc(GL_EQUAL);
+        GLState::depthMask(false);
 
-            for (auto& childGuiptr : gui->guis) {
+        // The light lists go after the mesh texture on unit 0.
+        m_lightGrid.use(1, 2);
 
-                auto& [ childgui, childTransform ] = *childGuiptr;
+        ShaderProgram* programs[] = { &m_forwardProgram, indirect ? &m_forwardIndirectProgram : nullptr };
+        for (ShaderProgram* program : programs) {
+            if (!program) continue;
+            program->setInt("u_tilesX", m_lightGrid.getTilesX());
+            program->setInt("u_directionalLights", m_lightGrid.getDirectionalLights());
+        }
 
-                TransformComponent childScaledTransform = getRelativeTransform2D(childTransform, scaledTransform);
+        drawGeometry(commands.meshes, m_forwardProgram, m_forwardIndirectProgram, indirect, projection, view);
 
-                auto model = childScaledTransform.getTransformation();
-                m_guiProgram.setMat4("u_model", glm::value_ptr(model));
+        GLState::depthFunc(GL_LESS);
+        GLState::depthMask(true);
+        GLState::disable(GL_DEPTH_TEST);
 
-                if (childgui.image) {
-                    Texture::setUnit(0);
-                    childgui.image->bind();
-                } else {
-                    Texture::setUnit(0);
-                    m_whiteTexture.bind();
-                }
+        m_gpuTimer.end();
+
+    }
 
-                m_guiProgram.setFloats("u_colour", glm::value_ptr(childgui.colour), 4);
+    // Only the fields that change what is drawn, unlike the GUI's state.
+    static bool sameGUI(const GUICommand& a, const GUICommand& b) {
+        return a.image == b.image && a.uvRect == b.uvRect && a.model == b.model && a.colour == b.colour;
+    }
 
-                // Since screenMesh is a generic quad, it can be used for this too.
-                m_guiQuad.draw();
-                
+    Renderer::GUIRedraw Renderer::getGUIRedraw(const std::vector<GUICommand>& guis, std::array<int, 4>& region) const {
+        const RetainedGUI& retained = m_retainedGUI;
+
+        // Anything that moves the GUI as a whole, or a resize that gave the target new attachments, means nothing
+        // from before can be kept.
+        if (!retained.valid || retained.frameWidth != m_frameWidth || retained.frameHeight != m_frameHeight
+            || retained.targetWidth != m_targetWidth || retained.targetHeight != m_targetHeight
+            || retained.targetAllocations != m_guiTarget.getAllocations()) return GUIRedraw::FULL;
+
+        // Each changed quad dirties both where it was and where it is now, in frame pixels.
+        glm::vec2 minimum(std::numeric_limits<float>::max()), maximum(std::numeric_limits<float>::lowest());
+        auto addBounds = [&](const GUICommand& command) {
+            for (float x : { -0.5f, 0.5f }) {
+                for (float y : { -0.5f, 0.5f }) {
+                    glm::vec2 corner = glm::vec2(command.model * glm::vec4(x, y, 0.0f, 1.0f));
+                    minimum = glm::min(minimum, corner);
+                    maximum = glm::max(maximum, corner);
+                }
             }
+        };
+
+        size_t count = std::max(guis.size(), retained.guis.size());
+        for (size_t i = 0; i < count; i++) {
+            bool hasOld = i < retained.guis.size(),
+                 hasNew = i < guis.size();
+            if (hasOld && hasNew && sameGUI(retained.guis[i], guis[i])) continue;
+            if (hasOld) addBounds(retained.guis[i]);
+            if (hasNew) addBounds(guis[i]);
         }
 
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_BLEND);
-        glEnable(GL_CULL_FACE);
+        if (maximum.x < minimum.x) return GUIRedraw::NONE;
 
-        glClearColor(0, 0, 0, 1);
+        // Into the target's pixels, which have their origin at the bottom left, widened by a pixel to cover rounding
+        // at the edges.
+        glm::vec2 scale(static_cast<float>(m_targetWidth) / static_cast<float>(m_frameWidth),
+            static_cast<float>(m_targetHeight) / static_cast<float>(m_frameHeight));
+        int left = std::max(static_cast<int>(std::floor(minimum.x * scale.x)) - 1, 0),
+            right = std::min(static_cast<int>(std::ceil(maximum.x * scale.x)) + 1, m_targetWidth),
+            top = std::max(static_cast<int>(std::floor(minimum.y * scale.y)) - 1, 0),
+            bottom = std::min(static_cast<int>(std::ceil(maximum.y * scale.y)) + 1, m_targetHeight);
 
-        // FINAL PASS --------------------------------------------------------|>
+        // Entirely off screen.
+        if (right <= left || bottom <= top) return GUIRedraw::NONE;
 
-        glEnable(GL_BLEND);
-        glBlendEquation(GL_FUNC_ADD);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        
-        m_finalTarget.bind();
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // Past this much of the screen the scissor saves too little to be worth it.
+        long long area = static_cast<long long>(right - left) * (bottom - top);
+        if (area * 2 > static_cast<long long>(m_targetWidth) * m_targetHeight) return GUIRedraw::FULL;
 
-        m_finalProgram.use();
+        region = { left, m_targetHeight - bottom, right - left, bottom - top };
+        return GUIRedraw::PARTIAL;
+    }
 
-        m_lightingTarget.use();
-        m_screenMesh.draw();
+    bool Renderer::drawGUI(const std::vector<GUICommand>& guis) {
+        if (guis.empty()) return true;
+
+        // Every quad of the frame goes into one allocation, as two triangles, with the sizes it is given in its
+        // transform already applied.
+        unsigned int vertexCount = static_cast<unsigned int>(guis.size()) * 6;
+        StreamAllocation allocation = m_streamBuffer.allocate(vertexCount * sizeof(GUIVertex), sizeof(GUIVertex));
+        if (!allocation) return false;
+
+        auto* vertices = static_cast<GUIVertex*>(allocation.data);
+        for (auto& command : guis) {
+            // The quad is a unit square around the GUI's position. Images are loaded upside down, so the top of the
+            // quad, which is the top of the screen, takes the top of the uv rect.
+            const glm::vec4& uv = command.uvRect;
+            auto corner = [&](float x, float y, float u, float v) {
+                return GUIVertex { glm::vec3(command.model * glm::vec4(x, y, 0.0f, 1.0f)), glm::vec2(u, v),
+                    command.colour };
+            };
+            GUIVertex corners[] = {
+                corner(-0.5f, -0.5f, uv.x, uv.w),
+                corner(0.5f, -0.5f, uv.z, uv.w),
+                corner(0.5f, 0.5f, uv.z, uv.y),
+                corner(-0.5f, 0.5f, uv.x, uv.y)
+            };
+            for (int index : { 0, 1, 2, 0, 2, 3 }) *vertices++ = corners[index];
+        }
+        m_streamBuffer.commit();
 
-#ifdef RG_DEBUG_SHOW_LIGHTS
+        m_guiVertexArray.bind();
 
-        // DEBUG LIGHTS SUBPASS ----------------------------------------------|>
+        // The allocation is aligned to the vertex size, so it starts on a whole vertex.
+        LOGGER.weakAssert(allocation.offset % sizeof(GUIVertex) == 0, "GUI vertices don't start on a whole vertex");
+        unsigned int first = allocation.offset / sizeof(GUIVertex);
 
-        glEnable(GL_DEPTH_TEST);
+        // Quads are blended in the order they were recorded, so only neighbouring quads sharing a texture can be
+        // drawn together. With the images in the GUI atlas that is normally every quad.
+        for (size_t begin = 0, end; begin < guis.size(); begin = end) {
+            const std::shared_ptr<Texture>& image = guis[begin].image;
+            for (end = begin + 1; end < guis.size() && guis[end].image == image; end++) {}
 
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_geometryTarget.m_framebuffer.m_handle);
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_finalTarget.m_framebuffer.m_handle);
+            Texture::setUnit(0);
+            image->bind();
 
-        glBlitFramebuffer(
-            0, 0, m_width, m_height,
-            0, 0, m_width, m_height,
-            GL_DEPTH_BUFFER_BIT,
-            GL_NEAREST
-            );
-        
-        m_finalTarget.bind();
+            glDrawArrays(GL_TRIANGLES, static_cast<GLint>(first + begin * 6), static_cast<GLsizei>((end - begin) * 6));
+            RG_RENDER_STAT(countDraw((end - begin) * 6, false));
+        }
 
-        m_debugLightProgram.use();
+        return true;
+    }
 
-        m_debugLightProgram.setMat4("u_projection", glm::value_ptr(projection));
-        m_debugLightProgram.setMat4("u_view", glm::value_ptr(view));
+    void Renderer::drawGeometry(const std::vector<MeshCommand>& meshes, ShaderProgram& program,
+        ShaderProgram& indirectProgram, bool indirect, const glm::mat4& projection, const glm::mat4& view) {
+        if (indirect) {
+            drawMeshesIndirect(meshes, indirectProgram, program, projection, view);
+        } else {
+            drawMeshes(meshes, program, projection, view, false);
+        }
+    }
 
-        for (auto& [ light, transform ] : scene.findAll<LightComponent, TransformComponent>()) {
+    void Renderer::drawMeshes(const std::vector<MeshCommand>& meshes, ShaderProgram& program,
+        const glm::mat4& projection, const glm::mat4& view, bool ownBuffersOnly) {
 
-            transform->scale = glm::vec3(0.1f);
-            if (light->type == LightComponent::LightType::DIRECTIONAL)
-                transform->scale.y *= 3.0f;
+        program.use();
+        program.setMat4("u_projection", glm::value_ptr(projection));
+        program.setMat4("u_view", glm::value_ptr(view));
 
-            auto model = transform->getTransformation();
-            m_debugLightProgram.setMat4("u_model", glm::value_ptr(model));
+        for (auto& command : meshes) {
+            if (ownBuffersOnly && command.mesh.getAllocation()) continue;
+            program.setMat4("u_model", glm::value_ptr(command.model));
+            program.setMat3("u_normalMatrix", glm::value_ptr(command.normalMatrix));
+            command.mesh.draw();
+        }
+    }
 
-            m_debugLightProgram.setFloats("u_lightColour", glm::value_ptr(light->colour), 3);
+    bool Renderer::uploadIndirect(const std::vector<MeshCommand>& meshes) {
+
+        // Matches the Draw struct in the indirect gbuffer shader, with the normal matrix padded out to std430's
+        // column alignment.
+        struct DrawData {
+            glm::mat4 model;
+            glm::mat4 normalMatrix;
+        };
+
+        unsigned int count = static_cast<unsigned int>(meshes.size());
+        m_indirectHasOwnBuffers = false;
+        if (!count) return true;
+
+        // Each draw's data is at the index given as its base instance, which is the index of its command.
+        StreamAllocation drawAllocation = m_streamBuffer.allocate(count * sizeof(DrawData),
+            static_cast<unsigned int>(m_storageAlignment));
+        if (!drawAllocation) return false;
+        auto* draws = static_cast<DrawData*>(drawAllocation.data);
+        for (unsigned int i = 0; i < count; i++) {
+            draws[i] = { meshes[i].model, glm::mat4(meshes[i].normalMatrix) };
+        }
 
-            m_debugLightMesh.draw();
-            
+        StreamAllocation indirectAllocation = m_streamBuffer.allocate(count * sizeof(DrawElementsIndirectCommand));
+        if (!indirectAllocation) return false;
+        auto* indirect = static_cast<DrawElementsIndirectCommand*>(indirectAllocation.data);
+        for (unsigned int i = 0; i < count; i++) {
+            const auto& allocation = meshes[i].mesh.getAllocation();
+            indirect[i] = allocation ? allocation->getIndirectCommand(i) : DrawElementsIndirectCommand {};
+            m_indirectHasOwnBuffers |= !allocation;
         }
+        m_streamBuffer.commit();
 
-        glDisable(GL_DEPTH_TEST);
-        
+        m_indirectDraws = drawAllocation;
+        m_indirectCommands = indirectAllocation;
+        return true;
+    }
+
+    void Renderer::drawMeshesIndirect(const std::vector<MeshCommand>& meshes, ShaderProgram& program,
+        ShaderProgram& fallbackProgram, const glm::mat4& projection, const glm::mat4& view) {
+
+        unsigned int count = static_cast<unsigned int>(meshes.size());
+        if (!count) return;
+
+        if (m_indirectHasOwnBuffers) drawMeshes(meshes, fallbackProgram, projection, view, true);
+
+        program.use();
+        program.setMat4("u_projection", glm::value_ptr(projection));
+        program.setMat4("u_view", glm::value_ptr(view));
+
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, m_streamBuffer.getHandle(), m_indirectDraws.offset,
+            m_indirectDraws.size);
+        m_streamBuffer.bind(GL_DRAW_INDIRECT_BUFFER);
+
+        // The commands are sorted by texture and then arena, so each run of them sharing both is one multi-draw.
+        for (unsigned int begin = 0, end; begin < count; begin = end) {
+            const Mesh& mesh = meshes[begin].mesh;
+            end = begin + 1;
+
+            const auto& allocation = mesh.getAllocation();
+            if (!allocation) continue;
+
+            while (end < count) {
+                const Mesh& next = meshes[end].mesh;
+                if (!next.getAllocation() || next.getAllocation()->getArena() != allocation->getArena()
+                    || next.getPrimaryTexture() != mesh.getPrimaryTexture()) break;
+                end++;
+            }
+
+            if (mesh.getPrimaryTexture()) {
+                Texture::setUnit(0);
+                mesh.getPrimaryTexture()->bind();
+            }
+            allocation->bind();
+
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                reinterpret_cast<const void*>(static_cast<uintptr_t>(m_indirectCommands.offset)
+                    + begin * sizeof(DrawElementsIndirectCommand)),
+                static_cast<GLsizei>(end - begin), 0);
+
+#ifdef RG_RENDER_STATS
+            unsigned long long indices = 0;
+            for (unsigned int i = begin; i < end; i++) indices += meshes[i].mesh.getAllocation()->getIndexCount();
+            RenderStats::countDraw(indices, true);
 #endif
+        }
+    }
 
-        m_finalProgram.use();
+    void Renderer::record(Scene& scene, CommandList& commands) {
 
-        m_guiTarget.use();
-        m_screenMesh.draw();
+        commands.width = m_width;
+        commands.height = m_height;
+        commands.lightingScale = m_lightingScale;
+        commands.depthPrePass = m_depthPrePassMode;
+        commands.renderPath = m_renderPath;
+        commands.sceneID = scene.getID();
 
-        glDisable(GL_BLEND);
-        
-        blit(m_finalTarget, renderTarget);
-        
+        commands.hasCamera = false;
+        for (auto& [ camera, cameraTransform ] : scene.view<CameraComponent, TransformComponent>()) {
+            commands.hasCamera = true;
+            commands.camera = { camera->fov, cameraTransform->position, cameraTransform->rotation };
+            break;
+        }
+
+        // Walking the views is left on this thread since it is cheap next to the per-entity maths, and it gives every
+        // entity an index so each chunk knows exactly which commands it is writing. The views are kept up to date by
+        // the scene, so this only touches the entities that are drawn.
+        m_meshEntities.clear();
+        for (auto& [ mesh, transform ] : scene.view<Mesh, TransformComponent>()) {
+            m_meshEntities.emplace_back(mesh, transform);
+        }
+
+        m_lightEntities.clear();
+        for (auto& [ light, transform ] : scene.view<LightComponent, TransformComponent>()) {
+            m_lightEntities.emplace_back(light, transform);
+        }
+
+        const std::vector<GUIRect>& guiRects = layoutGUI(scene).getRects();
+
+        // Last frame's commands are released here, on the thread with the context, since they can hold the last
+        // reference to a removed entity's textures and vertex arrays and the workers below can't delete those.
+        commands.meshes.clear();
+        commands.lights.clear();
+        commands.guis.clear();
+
+        // Every entity maps to exactly one command, so the lists are sized up front and each chunk fills its own
+        // slice. Nothing is shared between chunks and no merging is needed afterwards.
+        commands.meshes.resize(m_meshEntities.size());
+        commands.lights.resize(m_lightEntities.size());
+        commands.guis.resize(guiRects.size());
+
+        m_threadPool.parallelFor(m_meshEntities.size(), RECORD_CHUNK_SIZE, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                auto& [ mesh, transform ] = m_meshEntities[i];
+                MeshCommand& command = commands.meshes[i];
+
+                command.sortKey = mesh->getSortKey();
+                command.mesh = *mesh;
+                command.model = transform->getTransformation();
+                command.normalMatrix = glm::transpose(glm::inverse(glm::mat3(command.model)));
+            }
+        });
+
+        m_threadPool.parallelFor(m_lightEntities.size(), RECORD_CHUNK_SIZE, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                auto& [ light, transform ] = m_lightEntities[i];
+                LightCommand& command = commands.lights[i];
+
+                auto defaultLightDirection = glm::vec3(0.0f, 0.0f, -1.0f);
+
+                command.type = light->type;
+                command.position = transform->position;
+                command.rotation = transform->rotation;
+                command.direction = transform->rotation * defaultLightDirection;
+                command.colour = light->colour;
+                command.distance = light->distance;
+            }
+        });
+
+        const AtlasRegion& guiWhite = AssetFetcher::getGUIAtlas().getWhite();
+        m_threadPool.parallelFor(guiRects.size(), RECORD_CHUNK_SIZE, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const GUIRect& rect = guiRects[i];
+                const GUIComponent& gui = rect.element->first;
+                GUICommand& command = commands.guis[i];
+
+                if (gui.image) {
+                    command.image = gui.image;
+                    command.uvRect = gui.uvRect;
+                } else {
+                    command.image = guiWhite.texture;
+                    command.uvRect = guiWhite.uvRect;
+                }
+                command.model = rect.model;
+                command.colour = gui.colour;
+            }
+        });
+
+        // Opaque geometry is depth tested so its order doesn't matter, unlike the GUI which is blended and keeps
+        // the scene's order.
+        std::ranges::sort(commands.meshes, {}, &MeshCommand::sortKey);
+    }
+
+    GUILayout& Renderer::layoutGUI(Scene& scene) {
+        m_guiLayout.update(scene, m_width, m_height);
+        return m_guiLayout;
     }
 
     void Renderer::blit(const RenderTarget& src, RenderTarget* dst) {
         
-        glBindFramebuffer(
+        GLState::bindFramebuffer(
             GL_READ_FRAMEBUFFER,
             src.m_framebuffer.m_handle
             );
-        glBindFramebuffer(
+        GLState::bindFramebuffer(
             GL_DRAW_FRAMEBUFFER,
             dst ? dst->m_framebuffer.m_handle : 0
             );
 
         glBlitFramebuffer(
-            0, 0, m_width, m_height,
-            0, 0, dst ? dst->m_width : m_width, dst ? dst->m_height : m_height,
+            0, 0, m_targetWidth, m_targetHeight,
+            0, 0, dst ? dst->m_width : m_frameWidth, dst ? dst->m_height : m_frameHeight,
             GL_COLOR_BUFFER_BIT,
             GL_LINEAR
         );
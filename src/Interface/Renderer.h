@@ -1,10 +1,20 @@
 #pragma once
 
+#include <array>
+
+#include "Graphics/FrameCapture.h"
+#include "Graphics/GPUTimer.h"
+#include "Graphics/LightGrid.h"
 #include "Graphics/Mesh.h"
+#include "Graphics/OverdrawEstimator.h"
+#include "Graphics/RenderCommands.h"
 #include "Graphics/RenderTarget.h"
 #include "Graphics/ShaderProgram.h"
+#include "Graphics/StreamBuffer.h"
 #include "Scene/Components.h"
 #include "Scene/Scene.h"
+#include "GUILayout.h"
+#include "ThreadPool.h"
 
 namespace EcoSort {
 
@@ -13,40 +23,229 @@ namespace EcoSort {
 
         Renderer(int width, int height);
 
+        // Only takes effect for frames recorded after this. The render targets follow once frames have been rendered
+        // at the new size for a few frames in a row, so this makes no GL calls.
         void resize(int width, int height);
 
+        // Fill commands from the scene, with the per-entity work spread over worker threads. This only reads the
+        // scene and makes no GL calls, so it can run on a different thread to render.
+        void record(Scene& scene, CommandList& commands);
+
+        // Render recorded commands into the final target only. Must be called on the thread the context is current on.
+        void render(const CommandList& commands);
+        // renderTarget can be null, will present to the screen.
+        void render(const CommandList& commands, RenderTarget* renderTarget);
+
+        // Record and render in one go.
+        void renderScene(Scene& scene);
+        // renderTarget can be null, will present to the screen.
         void renderScene(Scene& scene, RenderTarget* renderTarget);
 
         // dst can be null, will blit to the screen.
         void blit(const RenderTarget& src, RenderTarget* dst);
 
+        // Bring the GUI layout up to date with the scene, for the size frames are laid out for. Recording does this
+        // too, so calling it first in a frame only means the work isn't done twice.
+        GUILayout& layoutGUI(Scene& scene);
+
         TransformComponent
         getAbsoluteTransform2D(const Transform2DComponent &transform);
         static TransformComponent getRelativeTransform2D(const Transform2DComponent& child, const TransformComponent& parent);
 
+        [[nodiscard]] GPUTimer& getGPUTimer() { return m_gpuTimer; }
+        // Per-frame dynamic data (instance data, GUI quads, debug geometry) should be uploaded through this.
+        [[nodiscard]] StreamBuffer& getStreamBuffer() { return m_streamBuffer; }
+        // Captures the final target at the end of every frame while it is capturing.
+        [[nodiscard]] FrameCapture& getFrameCapture() { return m_frameCapture; }
+
+        // Compute lighting at 1 / scale of the resolution in each direction, where scale is 1, 2 or 4, for frames
+        // recorded after this. Reduced lighting is upsampled with the G-buffer's depth and normals to keep edges sharp.
+        void setLightingScale(int scale);
+        [[nodiscard]] int getLightingScale() const { return m_lightingScale; }
+
+        // For frames recorded after this.
+        void setDepthPrePassMode(DepthPrePassMode mode) { m_depthPrePassMode = mode; }
+        // G-buffer fragment counts with and without the depth pre-pass, and the scenes' overdraw.
+        [[nodiscard]] const OverdrawEstimator& getOverdrawEstimator() const { return m_overdrawEstimator; }
+
+        // For frames recorded after this.
+        void setRenderPath(RenderPath path) { m_renderPath = path; }
+        // Frames rendered by each path so far.
+        [[nodiscard]] unsigned long long getForwardPlusFrames() const { return m_forwardPlusFrames; }
+        [[nodiscard]] unsigned long long getDeferredFrames() const { return m_deferredFrames; }
+
+        // Frames where the GUI didn't need redrawing, needed part of it redrawn, and needed all of it.
+        [[nodiscard]] std::array<unsigned long long, 3> getGUIRedrawCounts() const { return m_guiRedrawCounts; }
+
     private:
 
+        struct GUIVertex {
+            glm::vec3 position;
+            glm::vec2 uv;
+            glm::vec4 colour;
+        };
+
+        // The camera's clip planes. Passes that turn depth back into distance are given them as uniforms.
+        static constexpr float NEAR_PLANE = 0.1f;
+        static constexpr float FAR_PLANE = 10000.0f;
+
+        // Entities are split into chunks of at least this many for recording, so small scenes stay on one thread.
+        static constexpr size_t RECORD_CHUNK_SIZE = 256;
+
+        // Frames in a row a new size has to be rendered at before the render targets are resized to it.
+        static constexpr unsigned int RESIZE_SETTLE_FRAMES = 3;
+
+        // RenderPath::AUTO uses Forward+ while the number of lights times the number of pixels is at most this, which
+        // is 16 lights at 1920x1080. Each deferred light is a full screen pass over the G-buffer, on top of the fixed
+        // cost of writing and reading it, while Forward+ only pays for the lights in each pixel's tile but needs a
+        // pre-pass and a forward shader that loops over them.
+        static constexpr unsigned long long FORWARD_PLUS_LIGHT_PIXELS = 16ull * 1920 * 1080;
+
+        // Resize the render targets once width and height have stayed the same for RESIZE_SETTLE_FRAMES.
+        void settleTargets(int width, int height);
+        void resizeTargets(int width, int height);
+
+        [[nodiscard]] bool useForwardPlus(const CommandList& commands) const;
+
+        // Draw the G-buffer and light it into m_lightingTarget.
+        void renderDeferred(const CommandList& commands, const glm::mat4& projection, const glm::mat4& view,
+            bool indirect);
+        // Draw the scene shaded into m_finalTarget, with a depth pre-pass and the lights in m_lightGrid.
+        void renderForwardPlus(const CommandList& commands, const glm::mat4& projection, const glm::mat4& view,
+            bool indirect);
+
+        enum class GUIRedraw {
+            NONE,
+            // Only the region given by getGUIRedraw.
+            PARTIAL,
+            FULL
+        };
+
+        // How much of the GUI target has to be redrawn for guis, compared to what was last drawn into it. region is
+        // set to the scissor box for a partial redraw.
+        [[nodiscard]] GUIRedraw getGUIRedraw(const std::vector<GUICommand>& guis, std::array<int, 4>& region) const;
+        // Write every quad to the stream buffer and draw them in as few batches as their textures allow. Returns false
+        // without drawing anything if the stream buffer is too full for them.
+        bool drawGUI(const std::vector<GUICommand>& guis);
+
+        // Draw every mesh with program, or with indirectProgram through drawMeshesIndirect if indirect is set.
+        void drawGeometry(const std::vector<MeshCommand>& meshes, ShaderProgram& program,
+            ShaderProgram& indirectProgram, bool indirect, const glm::mat4& projection, const glm::mat4& view);
+        // The GL 4.1 path, with a draw and uniform updates per mesh. Meshes in the mesh heap are skipped if
+        // ownBuffersOnly is set.
+        void drawMeshes(const std::vector<MeshCommand>& meshes, ShaderProgram& program, const glm::mat4& projection,
+            const glm::mat4& view, bool ownBuffersOnly);
+        // Write each mesh's per-draw data and indirect command to the stream buffer for drawMeshesIndirect. Returns
+        // false if the stream buffer is too full for them.
+        bool uploadIndirect(const std::vector<MeshCommand>& meshes);
+        // One glMultiDrawElementsIndirect per run of heap meshes sharing a texture and arena, with the rest drawn by
+        // drawMeshes with fallbackProgram. uploadIndirect must have succeeded this frame.
+        void drawMeshesIndirect(const std::vector<MeshCommand>& meshes, ShaderProgram& program,
+            ShaderProgram& fallbackProgram, const glm::mat4& projection, const glm::mat4& view);
+
+        // The size frames are laid out for, which is what resize sets.
         int m_width,
             m_height;
 
+        // The size of the frame being rendered, which the projections are built from.
+        int m_frameWidth,
+            m_frameHeight;
+
+        // The size of the render targets, which lags behind the frame size while a resize settles.
+        int m_targetWidth,
+            m_targetHeight;
+
+        int m_pendingWidth = 0,
+            m_pendingHeight = 0;
+        unsigned int m_resizeFrames = 0;
+
         RenderTarget m_geometryTarget,
                      m_lightingTarget,
+                     // Lighting before it is upsampled, when it is computed at a reduced resolution.
+                     m_reducedLightingTarget,
                      m_guiTarget,
                      m_finalTarget;
 
         ShaderProgram m_geometryProgram,
-                      m_lightingProgram,
+                      m_depthProgram,
+                      // Only built when GLFeatures::hasMultiDrawIndirect.
+                      m_geometryIndirectProgram,
+                      m_depthIndirectProgram,
+                      m_forwardProgram,
+                      m_forwardDepthProgram,
+                      // Only built when GLFeatures::hasMultiDrawIndirect.
+                      m_forwardIndirectProgram,
                       m_guiProgram,
                       m_finalProgram,
+                      m_upsampleProgram,
 
                       m_debugLightProgram;
+
+        // One permutation of the lighting shader per light type, indexed by LightComponent::LightType, with the
+        // ambient pass at AMBIENT_LIGHTING.
+        static constexpr int AMBIENT_LIGHTING = 3;
+        std::array<ShaderProgram, 4> m_lightingPrograms;
+
+        // Set on the recording thread and copied into each command list.
+        int m_lightingScale = 1;
+        // The scale the lighting programs' uniforms were last set for.
+        int m_appliedLightingScale = 1;
         
         Mesh m_screenMesh,
-             m_guiQuad,
         
              m_debugLightMesh;
 
-        Texture m_whiteTexture;
+        VertexArray m_guiVertexArray;
+
+        GPUTimer m_gpuTimer;
+
+        StreamBuffer m_streamBuffer;
+        // GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, for the per-draw data of the indirect path.
+        int m_storageAlignment = 256;
+        // Written by uploadIndirect for the frame being rendered.
+        StreamAllocation m_indirectDraws,
+                         m_indirectCommands;
+        bool m_indirectHasOwnBuffers = false;
+
+        OverdrawEstimator m_overdrawEstimator;
+        // Set on the recording thread and copied into each command list.
+        DepthPrePassMode m_depthPrePassMode = DepthPrePassMode::AUTO;
+
+        LightGrid m_lightGrid;
+        // Set on the recording thread and copied into each command list.
+        RenderPath m_renderPath = RenderPath::AUTO;
+        unsigned long long m_forwardPlusFrames = 0,
+                           m_deferredFrames = 0;
+
+        FrameCapture m_frameCapture;
+
+        ThreadPool m_threadPool;
+
+        // Only used on the recording thread.
+        GUILayout m_guiLayout;
+
+        // What the GUI target currently holds.
+        struct RetainedGUI {
+            std::vector<GUICommand> guis;
+            int frameWidth = 0,
+                frameHeight = 0,
+                targetWidth = 0,
+                targetHeight = 0;
+            unsigned int targetAllocations = 0;
+            bool valid = false;
+        };
+
+        RetainedGUI m_retainedGUI;
+        // Frames that needed each kind of redraw, indexed by GUIRedraw.
+        std::array<unsigned long long, 3> m_guiRedrawCounts {};
+
+        // Used by renderScene, which records and renders on the same thread.
+        CommandList m_commands;
+
+        // Components gathered from the scene queries each frame so they can be indexed by chunk. Kept between frames
+        // to reuse their storage.
+        std::vector<std::pair<Mesh*, TransformComponent*>> m_meshEntities;
+        std::vector<std::pair<LightComponent*, TransformComponent*>> m_lightEntities;
         
     };
     
@@ -0,0 +1,104 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace EcoSort {
+
+    ThreadPool::ThreadPool(unsigned int workers) {
+        m_workers.reserve(workers);
+        for (unsigned int i = 0; i < workers; i++) {
+            m_workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+
+        for (auto& worker : m_workers) worker.join();
+    }
+
+    void ThreadPool::parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t, size_t)>& job) {
+        if (!count) return;
+
+        minChunkSize = std::max<size_t>(minChunkSize, 1);
+        // Aim for a few chunks per thread so one slow chunk doesn't hold everyone else up.
+        size_t chunkSize = std::max(minChunkSize, count / (getThreadCount() * 4) + 1);
+        size_t chunks = (count + chunkSize - 1) / chunkSize;
+
+        // Not worth waking anyone for.
+        if (chunks == 1 || m_workers.empty()) {
+            job(0, count);
+            return;
+        }
+
+        {
+            std::unique_lock lock(m_mutex);
+            // A worker that woke too late to help with the last job may still be on its way out.
+            m_done.wait(lock, [&] { return m_active == 0; });
+
+            m_job = &job;
+            m_count = count;
+            m_chunkSize = chunkSize;
+            m_chunks = chunks;
+            m_nextChunk = 0;
+            m_remaining = chunks;
+            m_generation++;
+        }
+        m_wake.notify_all();
+
+        while (runChunk()) {}
+
+        std::unique_lock lock(m_mutex);
+        m_done.wait(lock, [&] { return m_remaining == 0 && m_active == 0; });
+        m_job = nullptr;
+    }
+
+    unsigned int ThreadPool::getDefaultWorkerCount() {
+        // hardware_concurrency can return 0 when it can't tell.
+        unsigned int cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 0;
+    }
+
+    void ThreadPool::workerLoop() {
+        unsigned long long seenGeneration = 0;
+
+        while (true) {
+            {
+                std::unique_lock lock(m_mutex);
+                m_wake.wait(lock, [&] { return m_stopping || m_generation != seenGeneration; });
+                if (m_stopping) return;
+                seenGeneration = m_generation;
+                m_active++;
+            }
+
+            while (runChunk()) {}
+
+            {
+                std::lock_guard lock(m_mutex);
+                m_active--;
+            }
+            m_done.notify_all();
+        }
+    }
+
+    bool ThreadPool::runChunk() {
+        size_t chunk = m_nextChunk.fetch_add(1);
+        if (chunk >= m_chunks) return false;
+
+        size_t begin = chunk * m_chunkSize;
+        size_t end = std::min(begin + m_chunkSize, m_count);
+        (*m_job)(begin, end);
+
+        if (m_remaining.fetch_sub(1) == 1) {
+            // Lock so the notify can't slip in between parallelFor checking m_remaining and going to sleep.
+            std::lock_guard lock(m_mutex);
+            m_done.notify_all();
+        }
+        return true;
+    }
+
+}
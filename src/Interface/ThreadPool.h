@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace EcoSort {
+
+    // A fixed set of worker threads for splitting per-frame work, such as recording render commands, across cores.
+    // The thread calling parallelFor works through chunks alongside the workers rather than sitting idle, so a pool
+    // with no workers just runs everything inline.
+    class ThreadPool {
+    public:
+
+        // By default there is one worker per core besides the calling thread.
+        explicit ThreadPool(unsigned int workers = getDefaultWorkerCount());
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Split [0, count) into chunks of at least minChunkSize and call job(begin, end) for each, returning once all
+        // of them have finished. Chunks run in no particular order, so jobs should only write to their own range.
+        // Only one thread may call this at a time.
+        void parallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t, size_t)>& job);
+
+        [[nodiscard]] unsigned int getThreadCount() const { return static_cast<unsigned int>(m_workers.size()) + 1; }
+
+        static unsigned int getDefaultWorkerCount();
+
+    private:
+
+        void workerLoop();
+        // Claim and run the next chunk of the current job, returns false if there are none left.
+        bool runChunk();
+
+        std::vector<std::thread> m_workers;
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake,
+                                m_done;
+
+        // Only written under m_mutex while no worker is active, so workers can read them freely while they are.
+        const std::function<void(size_t, size_t)>* m_job = nullptr;
+        size_t m_count = 0,
+               m_chunkSize = 0,
+               m_chunks = 0;
+        unsigned long long m_generation = 0;
+        bool m_stopping = false;
+
+        unsigned int m_active = 0;
+        std::atomic<size_t> m_nextChunk = 0,
+                            m_remaining = 0;
+
+    };
+
+}
@@ -5,6 +5,10 @@
 #include <Game.h>
 #include <glad/gl.h>
 
+#include "Graphics/GLFeatures.h"
+#include "Graphics/GLState.h"
+#include "Graphics/VertexArray.h"
+
 namespace EcoSort {
 
     void glfwKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
@@ -53,7 +57,12 @@ namespace EcoSort {
         init();
     }
     
-    Window::Window(const char* name, int width, int height) {
+    Window::Window(const char* name, int width, int height, bool headless) : m_headless(headless) {
+
+        // A headless window is never shown, it only exists to own a context. GLFW still needs an X11 or Wayland
+        // display to create it, so machines without one have to provide a virtual one such as Xvfb. With Mesa this
+        // also works without a GPU through llvmpipe.
+        glfwWindowHint(GLFW_VISIBLE, headless ? GLFW_FALSE : GLFW_TRUE);
 
         m_window = glfwCreateWindow(width, height, name, nullptr, nullptr);
 
@@ -75,22 +84,69 @@ namespace EcoSort {
         int result = gladLoadGL(glfwGetProcAddress);
         LOGGER.strongAssert(result, "Failed to initialize GLAD");
         LOGGER.debug("OpenGL Version: {}", reinterpret_cast<const char *>(glGetString(GL_VERSION)));
+        GLFeatures::detect();
 
         int w, h;
         getFramebufferSize(&w, &h);
         
         m_renderer = new Renderer(w, h);
+
+        m_framePacer.applyPresentMode();
     }
 
     Window::~Window() {
+        stopRenderThread();
+        m_framePacer.release();
         glfwDestroyWindow(m_window);
     }
+
+    void Window::startRenderThread() {
+        if (m_renderThread) return;
+
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        m_resourceWindow = glfwCreateWindow(1, 1, "", nullptr, m_window);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+        LOGGER.strongAssert(m_resourceWindow, "Failed to create a shared context for the render thread");
+
+        glfwMakeContextCurrent(m_resourceWindow);
+        // The cache on this thread was for m_window's context.
+        GLState::invalidate();
+
+        m_renderThread = std::make_unique<RenderThread>(m_window, *m_renderer, m_framePacer, !m_headless);
+    }
+
+    void Window::stopRenderThread() {
+        if (!m_renderThread) return;
+
+        m_renderThread.reset();
+
+        glfwMakeContextCurrent(m_window);
+        GLState::invalidate();
+
+        glfwDestroyWindow(m_resourceWindow);
+        m_resourceWindow = nullptr;
+    }
     
     void Window::update() {
 
-        m_renderer->renderScene(Game::getInstance()->getActiveScene(), nullptr);
-        
-        glfwSwapBuffers(m_window);
+        if (m_renderThread) {
+            m_renderThread->submit(Game::getInstance()->getActiveScene());
+            return;
+        }
+
+        // Vertex arrays released on other threads, such as the renderer's recording workers, are deleted here when
+        // there is no render thread to do it.
+        VertexArray::collectOrphans();
+
+        // Nothing is presented in headless mode, so the frame is only rendered into the renderer's final target.
+        if (m_headless) {
+            m_renderer->renderScene(Game::getInstance()->getActiveScene());
+        } else {
+            m_renderer->renderScene(Game::getInstance()->getActiveScene(), nullptr);
+            glfwSwapBuffers(m_window);
+        }
+
+        m_framePacer.endFrame();
     }
     
 }
\ No newline at end of file
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <memory>
+
 #include <GLFW/glfw3.h>
 
+#include "FramePacer.h"
 #include "Interface.h"
 #include "Renderer.h"
+#include "RenderThread.h"
 
 namespace EcoSort {
 
@@ -11,10 +15,16 @@ namespace EcoSort {
     public:
 
         Window(const char* name);
-        Window(const char* name, int width, int height);
+        Window(const char* name, int width, int height, bool headless = false);
         ~Window();
 
         void update();
+
+        // Move rendering onto its own thread. update then only records a snapshot of the scene, and the next frame can
+        // be simulated while the last is still being drawn and presented.
+        void startRenderThread();
+        // Wait for the last frame to be drawn and bring rendering back onto this thread.
+        void stopRenderThread();
         
         void setTitle(const char* title) { glfwSetWindowTitle(m_window, title); }
 
@@ -22,18 +32,29 @@ namespace EcoSort {
         void getFramebufferSize(int* w, int* h) { glfwGetFramebufferSize(m_window, w, h); }
 
         [[nodiscard]] bool isOpen() const { return !glfwWindowShouldClose(m_window); }
+        [[nodiscard]] bool isHeadless() const { return m_headless; }
         
         [[nodiscard]] Interface& getInterface() { return m_interface; }
         [[nodiscard]] Renderer* getRenderer() { return m_renderer; }
+        [[nodiscard]] RenderThread* getRenderThread() { return m_renderThread.get(); }
+        [[nodiscard]] FramePacer& getFramePacer() { return m_framePacer; }
 
     private:
 
         void init();
 
         GLFWwindow* m_window;
+        bool m_headless = false;
 
         Renderer* m_renderer;
         Interface m_interface;
+
+        FramePacer m_framePacer;
+
+        std::unique_ptr<RenderThread> m_renderThread;
+        // A hidden window whose context shares objects with m_window's, which is current on this thread while the
+        // render thread has m_window's. It lets textures and buffers still be created here.
+        GLFWwindow* m_resourceWindow = nullptr;
         
     };
     
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Graphics/Texture.h"
+#include "Graphics/TextureAtlas.h"
 
 #include "glm/detail/type_quat.hpp"
 #include "glm/fwd.hpp"
@@ -8,9 +9,12 @@
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
 
+#include <unordered_set>
+
 #include "BOO/BOO.h"
 #include "dynamics/q3Body.h"
 #include "Interface/Interface.h"
+#include "Scene/EntityHandle.h"
 
 namespace EcoSort {
 
@@ -62,10 +66,17 @@ namespace EcoSort {
 
         glm::vec4 colour = glm::vec4(1.0f);
         std::shared_ptr<Texture> image = nullptr;
+        // The part of image to draw, as in AtlasRegion.
+        glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
 
         bool isClicked = false;
         bool isHovered = false;
 
+        void setImage(const AtlasRegion& region) {
+            image = region.texture;
+            uvRect = region.uvRect;
+        }
+
     };
 
     struct GUIFrameComponent {
@@ -101,7 +112,9 @@ namespace EcoSort {
     };
 
     struct ConveyorComponent {
-        std::vector<BOO::ComponentRef<RigidBodyComponent>> touchingRubbish; 
+        // Handles rather than refs, so rubbish that is removed while touching a conveyor is seen to be gone without
+        // comparing it against anything.
+        std::unordered_set<ComponentHandle<RigidBodyComponent>> touchingRubbish;
     };
 
     struct PusherComponent {
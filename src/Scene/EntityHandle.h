@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace EcoSort {
+
+    // A compact reference to an entity that can tell when the entity has been removed, even if its slot has since
+    // been reused. The index is into the scene's handle table, and the generation is bumped every time that slot's
+    // entity is removed, so a stale handle no longer matches. Resolved through Scene::isValid and Scene::getEntity.
+    struct EntityHandle {
+
+        static constexpr std::uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+        std::uint32_t index = INVALID_INDEX,
+                      generation = 0;
+
+        bool operator==(const EntityHandle&) const = default;
+        // Only whether this refers to anything at all, not whether that is still alive.
+        explicit operator bool() const { return index != INVALID_INDEX; }
+
+    };
+
+    // An entity handle that also says which of its components it refers to, resolved through Scene::getComponent.
+    template<typename T>
+    struct ComponentHandle {
+
+        EntityHandle entity;
+
+        bool operator==(const ComponentHandle&) const = default;
+        explicit operator bool() const { return static_cast<bool>(entity); }
+
+    };
+
+}
+
+template<>
+struct std::hash<EcoSort::EntityHandle> {
+    size_t operator()(const EcoSort::EntityHandle& handle) const noexcept {
+        return std::hash<std::uint64_t>()(static_cast<std::uint64_t>(handle.generation) << 32 | handle.index);
+    }
+};
+
+template<typename T>
+struct std::hash<EcoSort::ComponentHandle<T>> {
+    size_t operator()(const EcoSort::ComponentHandle<T>& handle) const noexcept {
+        return std::hash<EcoSort::EntityHandle>()(handle.entity);
+    }
+};
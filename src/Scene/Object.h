@@ -15,22 +15,54 @@ namespace EcoSort {
         void destroy();
         bool valid();
 
+        [[nodiscard]] BOO::EntityID getEntity() const { return m_entityID; }
+
+        // Adding and removing components keeps the scene's views up to date, so it must not be done on the registry
+        // directly.
         template<typename T>
-        BOO::ComponentRef<T> addComponent() { return m_scene.m_registry.addComponentToEntity<T>(m_entityID); }
+        BOO::ComponentRef<T> addComponent() {
+            BOO::ComponentRef<T> component = m_scene.m_registry.addComponentToEntity<T>(m_entityID);
+            m_scene.componentsMoved<T>();
+            m_scene.updateViews(m_entityID);
+            return component;
+        }
         template<typename T>
         BOO::ComponentRef<T> getComponent() { return m_scene.m_registry.getComponentFromEntity<T>(m_entityID); }
         template<typename T>
-        void removeComponent() { m_scene.m_registry.removeComponentFromEntity<T>(m_entityID); }
+        void removeComponent() {
+            m_scene.m_registry.removeComponentFromEntity<T>(m_entityID);
+            m_scene.componentsMoved<T>();
+            m_scene.updateViews(m_entityID);
+        }
         template<typename T>
         bool hasComponent() const { return m_scene.m_registry.entityHasComponent<T>(m_entityID); }
+        // The handle is kept after the first call, so objects that live for a while (like the ones rigid bodies point
+        // to) only look their entity up in the scene once, unless the slot has since been reused.
+        [[nodiscard]] EntityHandle getHandle() {
+            if (!m_scene.isValid(m_handle) || m_scene.getEntity(m_handle) != m_entityID) {
+                m_handle = m_scene.getHandle(m_entityID);
+            }
+            return m_handle;
+        }
+        template<typename T>
+        [[nodiscard]] ComponentHandle<T> getComponentHandle() { return { getHandle() }; }
+
         template<typename T>
-        void setComponent(const T& component) { m_scene.m_registry.setComponentOnEntity<T>(m_entityID, component); }
+        void setComponent(const T& component) {
+            // Adds the component if the entity doesn't have it yet.
+            bool added = !hasComponent<T>();
+            m_scene.m_registry.setComponentOnEntity<T>(m_entityID, component);
+            if (!added) return;
+            m_scene.componentsMoved<T>();
+            m_scene.updateViews(m_entityID);
+        }
 
     private:
 
         friend class Scene;
         Scene& m_scene;
         BOO::EntityID m_entityID;
+        EntityHandle m_handle;
         
     };
     
@@ -4,8 +4,54 @@
 
 namespace EcoSort {
 
+    Scene& Scene::operator=(const Scene& other) {
+        if (this == &other) return *this;
+        m_id = other.m_id;
+        m_registry = other.m_registry;
+        m_handleSlots = other.m_handleSlots;
+        m_freeHandleSlots = other.m_freeHandleSlots;
+        m_handleIndices = other.m_handleIndices;
+        m_componentCaches.clear();
+        m_commands.clear();
+        for (auto& view : m_views) {
+            if (view) view->rebuild(m_registry);
+        }
+        return *this;
+    }
+
     void Scene::removeObject(Object& object) {
+        for (auto& view : m_views) {
+            if (view) view->remove(object.m_entityID);
+        }
         m_registry.destroyEntity(object.m_entityID);
+        allComponentsMoved();
+
+        // Every handle to the entity goes stale, without anything having to find them.
+        auto it = m_handleIndices.find(object.m_entityID);
+        if (it == m_handleIndices.end()) return;
+        HandleSlot& slot = m_handleSlots[it->second];
+        slot.alive = false;
+        slot.generation++;
+        m_freeHandleSlots.push_back(it->second);
+        m_handleIndices.erase(it);
+    }
+
+    EntityHandle Scene::getHandle(BOO::EntityID entity) {
+        auto [ it, inserted ] = m_handleIndices.try_emplace(entity, 0);
+        if (!inserted) return { it->second, m_handleSlots[it->second].generation };
+
+        if (m_freeHandleSlots.empty()) {
+            it->second = static_cast<std::uint32_t>(m_handleSlots.size());
+            m_handleSlots.emplace_back();
+        } else {
+            it->second = m_freeHandleSlots.back();
+            m_freeHandleSlots.pop_back();
+        }
+
+        HandleSlot& slot = m_handleSlots[it->second];
+        slot.entity = entity;
+        slot.alive = true;
+        return { it->second, slot.generation };
     }
 
     
@@ -13,5 +59,30 @@ namespace EcoSort {
          return Object(*this);
     }
 
+    void Scene::updateViews(BOO::EntityID entity) {
+        for (auto& view : m_views) {
+            if (view) view->update(m_registry, entity);
+        }
+    }
+
+    void Scene::componentsMoved(unsigned int type) {
+        if (type < m_componentVersions.size()) m_componentVersions[type]++;
+    }
+
+    void Scene::allComponentsMoved() {
+        for (auto& version : m_componentVersions) version++;
+    }
+
+    Scene::CachedComponent& Scene::getCachedComponent(unsigned int type, std::uint32_t index) {
+        if (type >= m_componentVersions.size()) {
+            m_componentVersions.resize(type + 1, 1);
+            m_componentCaches.resize(type + 1);
+        }
+
+        std::vector<CachedComponent>& cache = m_componentCaches[type];
+        if (index >= cache.size()) cache.resize(m_handleSlots.size());
+        return cache[index];
+    }
+
     
 }
\ No newline at end of file
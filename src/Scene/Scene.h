@@ -1,16 +1,41 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include <BOO/BOO.h>
 
+#include "EntityHandle.h"
+#include "SceneCommandBuffer.h"
+#include "SceneView.h"
+
 namespace EcoSort {
     class Object;
 
     class Scene {
     public:
-        
+
+        Scene() : m_id(nextID()) {}
+        // Views aren't copied, since they refer to the other registry. A scene that is assigned to keeps its views
+        // and rebuilds them, so references to them stay valid. Pending commands refer to entities in the registry
+        // that is being replaced, so they are never copied and are thrown away on assignment. Cached components point
+        // into the other registry too, so they are dropped the same way.
+        Scene(const Scene& other) : m_id(other.m_id), m_registry(other.m_registry), m_handleSlots(other.m_handleSlots),
+            m_freeHandleSlots(other.m_freeHandleSlots), m_handleIndices(other.m_handleIndices) {}
+        Scene& operator=(const Scene& other);
+
         Object createObject();
         void removeObject(Object& object);
 
+        // Identifies what the scene holds rather than where it is, for anything kept per scene. It is copied along
+        // with the contents, so a scene assigned another's contents takes its id too.
+        [[nodiscard]] unsigned int getID() const { return m_id; }
+
+        // Each of these builds a new list of every match, which is slow for queries made every frame but safe to
+        // iterate while adding and removing components.
         template<typename... T>
         BOO::QueryResult<T...> findAll() { return m_registry.queryAll<T...>(); }
 
@@ -20,8 +45,122 @@ namespace EcoSort {
         template<typename... T>
         BOO::QueryResult<T...> findMatch() { return m_registry.queryMatch<T...>(); }
 
+        // The same entities as findAll, from a view that is built the first time it is asked for and kept up to date
+        // from then on. Every component add and remove has to update each view, so only queries made often should
+        // have one.
+        template<typename... T>
+        SceneView<T...>& view() {
+            unsigned int id = SceneView<T...>::getID();
+            if (id >= m_views.size()) m_views.resize(id + 1);
+
+            std::unique_ptr<SceneViewBase>& view = m_views[id];
+            if (!view) {
+                view = std::make_unique<SceneView<T...>>();
+                view->rebuild(m_registry);
+            }
+            return static_cast<SceneView<T...>&>(*view);
+        }
+
+        // Structural changes to make at the next flushCommands, for anything that can't make them straight away
+        // because the scene is being iterated or it is running on another thread.
+        [[nodiscard]] SceneCommandBuffer& getCommands() { return m_commands; }
+        void flushCommands() { m_commands.flush(*this); }
+
+        // Give the entity a slot in the handle table if it hasn't got one yet, and return its handle. Handles copied
+        // with the scene stay valid in the copy.
+        EntityHandle getHandle(BOO::EntityID entity);
+        [[nodiscard]] bool isValid(EntityHandle handle) const {
+            return handle.index < m_handleSlots.size() && m_handleSlots[handle.index].generation == handle.generation
+                && m_handleSlots[handle.index].alive;
+        }
+        // Only meaningful for a valid handle.
+        [[nodiscard]] BOO::EntityID getEntity(EntityHandle handle) const { return m_handleSlots[handle.index].entity; }
+
+        template<typename T>
+        ComponentHandle<T> getComponentHandle(BOO::EntityID entity) { return { getHandle(entity) }; }
+        // Null if the entity has been removed or no longer has the component. The component is cached against the
+        // handle's slot, so until components of T are next added or removed (or any entity is removed) resolving the
+        // handle again is only a couple of table lookups, without going through the registry.
+        template<typename T>
+        T* getComponent(ComponentHandle<T> handle) {
+            if (!isValid(handle.entity)) return nullptr;
+
+            unsigned int type = componentTypeID<T>();
+            if (type < m_componentCaches.size() && handle.entity.index < m_componentCaches[type].size()) {
+                const CachedComponent& cached = m_componentCaches[type][handle.entity.index];
+                if (cached.component && cached.version == m_componentVersions[type]) {
+                    return static_cast<T*>(cached.component);
+                }
+            }
+
+            BOO::EntityID entity = getEntity(handle.entity);
+            if (!m_registry.entityHasComponent<T>(entity)) return nullptr;
+            T* component = m_registry.getComponentFromEntity<T>(entity).get();
+            getCachedComponent(type, handle.entity.index) = { component, m_componentVersions[type] };
+            return component;
+        }
+
     private:
         friend class Object;
+
+        struct HandleSlot {
+            BOO::EntityID entity;
+            std::uint32_t generation = 0;
+            bool alive = false;
+        };
+
+        // Null until the component has been looked up, and stale once its version no longer matches its type's.
+        struct CachedComponent {
+            void* component = nullptr;
+            std::uint32_t version = 0;
+        };
+
+        static unsigned int nextID() {
+            static std::atomic<unsigned int> s_next = 0;
+            return s_next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Every component type gets its own list of cached components, numbered the first time it is used.
+        template<typename T>
+        static unsigned int componentTypeID() {
+            static const unsigned int s_id = nextComponentTypeID();
+            return s_id;
+        }
+        static unsigned int nextComponentTypeID() {
+            static std::atomic<unsigned int> s_next = 0;
+            return s_next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Called by Object after any change to an entity's components.
+        void updateViews(BOO::EntityID entity);
+
+        // BOO only moves a type's components around when one of that type is added or removed, so that is when the
+        // pointers cached for it go stale. Called by Object for those changes, and for every type on removing an
+        // entity.
+        template<typename T>
+        void componentsMoved() { componentsMoved(componentTypeID<T>()); }
+        void componentsMoved(unsigned int type);
+        void allComponentsMoved();
+
+        // The cache entry for the handle slot index, making room for it first if needed.
+        CachedComponent& getCachedComponent(unsigned int type, std::uint32_t index);
+
+        unsigned int m_id;
         BOO::Registry m_registry;
+        // Indexed by SceneView::getID, and null for views this scene hasn't been asked for.
+        std::vector<std::unique_ptr<SceneViewBase>> m_views;
+
+        // Indexed by EntityHandle::index. Slots are only given out to entities something has asked for a handle to,
+        // and are reused once their entity has been removed.
+        std::vector<HandleSlot> m_handleSlots;
+        std::vector<std::uint32_t> m_freeHandleSlots;
+        std::unordered_map<BOO::EntityID, std::uint32_t> m_handleIndices;
+
+        // Both indexed by componentTypeID, and the caches then by EntityHandle::index. Versions start at 1 so an entry
+        // that has never been filled in can't match.
+        std::vector<std::uint32_t> m_componentVersions;
+        std::vector<std::vector<CachedComponent>> m_componentCaches;
+
+        SceneCommandBuffer m_commands;
     };
 }
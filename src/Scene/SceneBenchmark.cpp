@@ -0,0 +1,80 @@
+#include "SceneBenchmark.h"
+
+#include <chrono>
+#include <vector>
+
+#include "Components.h"
+#include "Game.h"
+#include "Object.h"
+
+namespace EcoSort {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        double millisecondsSince(Clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        // Reads every matched transform, so the loops can't be optimised away and the cost of reaching each
+        // component is part of the timing.
+        template<typename Query>
+        float sumHeights(Query&& query) {
+            float sum = 0.0f;
+            for (auto& [ _, transform ] : query) sum += transform->position.y;
+            return sum;
+        }
+
+        // Components added to and removed from entities to time how long keeping a view up to date takes.
+        constexpr unsigned int CHANGES = 1000;
+
+        void benchmark(unsigned int entities) {
+            // A quarter of the entities match, so a query that looks at every entity shows up against one that only
+            // looks at the matches.
+            Scene scene;
+            std::vector<Object> unmatched;
+            for (unsigned int i = 0; i < entities; i++) {
+                Object object = scene.createObject();
+                object.addComponent<TransformComponent>()->position.y = static_cast<float>(i);
+                if (i % 4 == 0) object.addComponent<RubbishComponent>();
+                else if (unmatched.size() < CHANGES) unmatched.push_back(object);
+            }
+
+            constexpr unsigned int ITERATIONS = 20;
+            volatile float sink = 0.0f;
+
+            Clock::time_point start = Clock::now();
+            for (unsigned int i = 0; i < ITERATIONS; i++) {
+                sink = sink + sumHeights(scene.findAll<RubbishComponent, TransformComponent>());
+            }
+            double findAllTime = millisecondsSince(start) / ITERATIONS;
+
+            start = Clock::now();
+            auto& view = scene.view<RubbishComponent, TransformComponent>();
+            double buildTime = millisecondsSince(start);
+
+            start = Clock::now();
+            for (unsigned int i = 0; i < ITERATIONS; i++) sink = sink + sumHeights(view);
+            double viewTime = millisecondsSince(start) / ITERATIONS;
+
+            // What keeping the view up to date costs, by adding and removing a component on entities that don't
+            // match yet.
+            start = Clock::now();
+            for (Object& object : unmatched) {
+                object.addComponent<RubbishComponent>();
+                object.removeComponent<RubbishComponent>();
+            }
+            double changeTime = millisecondsSince(start) * 1000.0 / static_cast<double>(unmatched.size() * 2);
+
+            LOGGER.info("{} entities, {} matching: findAll {:.3f}ms, view {:.3f}ms (built in {:.3f}ms), "
+                "{:.3f}us per component change", entities, view.size(), findAllTime, viewTime, buildTime, changeTime);
+        }
+
+    }
+
+    void benchmarkSceneQueries() {
+        for (unsigned int entities : { 10000u, 100000u }) benchmark(entities);
+    }
+
+}
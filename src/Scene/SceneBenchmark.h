@@ -0,0 +1,9 @@
+#pragma once
+
+namespace EcoSort {
+
+    // Time findAll against a view over scenes of 10k and 100k entities and log the results. Nothing is rendered, so
+    // this can run without a window.
+    void benchmarkSceneQueries();
+
+}
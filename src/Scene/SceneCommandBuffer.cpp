@@ -0,0 +1,79 @@
+#include "SceneCommandBuffer.h"
+
+#include "Game.h"
+#include "Object.h"
+
+namespace EcoSort {
+
+    DeferredEntity SceneCommandBuffer::createObject() {
+        std::lock_guard lock(m_mutex);
+        DeferredEntity entity = { m_batch, m_created++ };
+        m_commands.push_back({ CommandType::CREATE, entity, {} });
+        return entity;
+    }
+
+    void SceneCommandBuffer::removeObject(CommandTarget target) {
+        std::lock_guard lock(m_mutex);
+        m_commands.push_back({ CommandType::REMOVE, target, {} });
+    }
+
+    void SceneCommandBuffer::record(CommandTarget target, std::function<void(Object&)> apply) {
+        std::lock_guard lock(m_mutex);
+        m_commands.push_back({ CommandType::APPLY, target, std::move(apply) });
+    }
+
+    void SceneCommandBuffer::flush(Scene& scene) {
+        unsigned int batch;
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_commands.empty()) return;
+            std::swap(m_commands, m_flushing);
+            batch = m_batch++;
+            m_created = 0;
+        }
+
+        // The entities created by this batch, indexed by DeferredEntity::index.
+        std::vector<BOO::EntityID> created;
+        for (auto& command : m_flushing) {
+            if (command.type == CommandType::CREATE) {
+                created.push_back(scene.createObject().getEntity());
+                continue;
+            }
+
+            BOO::EntityID entity;
+            if (auto* deferred = std::get_if<DeferredEntity>(&command.target)) {
+                // Only entities this batch created are in created. Anything else refers to an entity from a batch
+                // that has already been flushed or thrown away, which nothing can map back to.
+                if (deferred->batch != batch || deferred->index >= created.size()) {
+                    LOGGER.warn("Skipping scene command on deferred entity {} from batch {} while flushing batch {}",
+                        deferred->index, deferred->batch, batch);
+                    continue;
+                }
+                entity = created[deferred->index];
+            } else {
+                entity = std::get<BOO::EntityID>(command.target);
+            }
+
+            Object object(scene, entity);
+            if (!object.valid()) continue;
+
+            if (command.type == CommandType::REMOVE) scene.removeObject(object);
+            else command.apply(object);
+        }
+
+        m_flushing.clear();
+    }
+
+    void SceneCommandBuffer::clear() {
+        std::lock_guard lock(m_mutex);
+        m_commands.clear();
+        m_batch++;
+        m_created = 0;
+    }
+
+    bool SceneCommandBuffer::empty() {
+        std::lock_guard lock(m_mutex);
+        return m_commands.empty();
+    }
+
+}
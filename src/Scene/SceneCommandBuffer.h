@@ -0,0 +1,89 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <BOO/BOO.h>
+
+namespace EcoSort {
+
+    class Object;
+    class Scene;
+
+    // An entity that a command buffer will create when it is flushed, which later commands in the same batch can
+    // refer to before it exists. A batch is everything recorded between two flushes.
+    struct DeferredEntity {
+        unsigned int batch,
+                     index;
+    };
+
+    using CommandTarget = std::variant<BOO::EntityID, DeferredEntity>;
+
+    // Records structural changes to a scene (creating and removing entities, adding and removing components) so they
+    // can be made all at once at a point where nothing is iterating the scene. Commands can be recorded from any
+    // thread, and are applied in the order they were recorded.
+    //
+    // Commands on an entity that has been removed by the time they are applied are skipped, so removing the same
+    // entity from several places is harmless. So are commands on a DeferredEntity from an earlier batch, which can
+    // happen when another thread flushes between creating an entity and recording the rest of its commands, so
+    // anything recording from another thread that has to see its entity made whole should finish before the flush.
+    class SceneCommandBuffer {
+    public:
+
+        SceneCommandBuffer() = default;
+
+        SceneCommandBuffer(const SceneCommandBuffer&) = delete;
+        SceneCommandBuffer& operator=(const SceneCommandBuffer&) = delete;
+
+        DeferredEntity createObject();
+        void removeObject(CommandTarget target);
+
+        // Set the component, adding it if the entity doesn't have one.
+        template<typename T>
+        void addComponent(CommandTarget target, T component = {}) {
+            record(target, [component = std::move(component)](auto& object) { object.setComponent(component); });
+        }
+
+        template<typename T>
+        void removeComponent(CommandTarget target) {
+            record(target, [](auto& object) { object.template removeComponent<T>(); });
+        }
+
+        // Apply every command recorded so far and start a new batch. Must only be called from the thread that owns the
+        // scene, at a point where nothing is iterating it.
+        void flush(Scene& scene);
+        // Throw away every command recorded so far, and start a new batch.
+        void clear();
+
+        [[nodiscard]] bool empty();
+
+    private:
+
+        enum class CommandType {
+            CREATE,
+            REMOVE,
+            APPLY
+        };
+
+        struct Command {
+            CommandType type;
+            CommandTarget target;
+            std::function<void(Object&)> apply;
+        };
+
+        void record(CommandTarget target, std::function<void(Object&)> apply);
+
+        std::mutex m_mutex;
+        std::vector<Command> m_commands;
+        // Swapped with m_commands to flush, so its storage is reused rather than reallocated every frame.
+        std::vector<Command> m_flushing;
+        // The batch being recorded, and how many entities it creates.
+        unsigned int m_batch = 0,
+                     m_created = 0;
+
+    };
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <BOO/BOO.h>
+
+namespace EcoSort {
+
+    // What a scene needs from a view to keep it up to date, whatever components it is over.
+    class SceneViewBase {
+    public:
+
+        virtual ~SceneViewBase() = default;
+
+        // Add or drop an entity whose components have changed, depending on whether it still matches.
+        virtual void update(BOO::Registry& registry, BOO::EntityID entity) = 0;
+        virtual void remove(BOO::EntityID entity) = 0;
+        virtual void rebuild(BOO::Registry& registry) = 0;
+
+    protected:
+
+        // Every combination of components gets its own slot in a scene's views, numbered the first time it is used.
+        static unsigned int nextID() {
+            static std::atomic<unsigned int> s_next = 0;
+            return s_next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+    };
+
+    // The entities with every one of T, kept up to date as components are added and removed through Object, so
+    // iterating it doesn't allocate or look at any entity that doesn't match. Entities are in the order they started
+    // matching, except that removing one moves the last into its place.
+    //
+    // Like the registry, nothing may add or remove components while a view is being iterated, which is what
+    // Scene::findAll's copy is for.
+    template<typename... T>
+    class SceneView : public SceneViewBase {
+    public:
+
+        using Entry = std::tuple<BOO::ComponentRef<T>...>;
+
+        static unsigned int getID() {
+            static const unsigned int s_id = nextID();
+            return s_id;
+        }
+
+        void update(BOO::Registry& registry, BOO::EntityID entity) override {
+            bool matches = (registry.entityHasComponent<T>(entity) && ...);
+            bool contained = m_indices.contains(entity);
+            if (matches && !contained) add(registry, entity);
+            else if (!matches && contained) remove(entity);
+        }
+
+        void remove(BOO::EntityID entity) override {
+            auto it = m_indices.find(entity);
+            if (it == m_indices.end()) return;
+
+            size_t index = it->second;
+            m_indices.erase(it);
+            if (index != m_entries.size() - 1) {
+                m_entries[index] = std::move(m_entries.back());
+                m_entities[index] = m_entities.back();
+                m_indices[m_entities[index]] = index;
+            }
+            m_entries.pop_back();
+            m_entities.pop_back();
+        }
+
+        void rebuild(BOO::Registry& registry) override {
+            m_entries.clear();
+            m_entities.clear();
+            m_indices.clear();
+            for (auto& entry : registry.queryAll<T...>()) add(registry, std::get<0>(entry).getEntity());
+        }
+
+        [[nodiscard]] auto begin() { return m_entries.begin(); }
+        [[nodiscard]] auto end() { return m_entries.end(); }
+        [[nodiscard]] size_t size() const { return m_entries.size(); }
+        [[nodiscard]] bool empty() const { return m_entries.empty(); }
+        [[nodiscard]] Entry& operator[](size_t index) { return m_entries[index]; }
+
+    private:
+
+        void add(BOO::Registry& registry, BOO::EntityID entity) {
+            m_indices.emplace(entity, m_entries.size());
+            m_entries.emplace_back(registry.getComponentFromEntity<T>(entity)...);
+            m_entities.push_back(entity);
+        }
+
+        std::vector<Entry> m_entries;
+        // The entity of each entry, so the one moved by a removal can be found in m_indices.
+        std::vector<BOO::EntityID> m_entities;
+        std::unordered_map<BOO::EntityID, size_t> m_indices;
+
+    };
+
+}
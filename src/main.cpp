@@ -1,11 +1,82 @@
 #include "Game.h"
+#include "Scene/SceneBenchmark.h"
 
-int main() {
+#include <charconv>
+#include <string>
+#include <string_view>
+
+namespace {
+
+    // Parse all of value into result, leaving result as it was and warning if value isn't a number of its type.
+    template<typename T>
+    void parseNumber(EcoSort::Game& game, std::string_view arg, std::string_view value, T& result) {
+        T parsed {};
+        auto [ end, error ] = std::from_chars(value.data(), value.data() + value.size(), parsed);
+        if (error != std::errc() || end != value.data() + value.size()) {
+            game.getLogger().warn("Invalid value for {}: {}", arg, value);
+            return;
+        }
+        result = parsed;
+    }
+
+}
+
+int main(int argc, char** argv) {
     
     EcoSort::Game game;
 
     EcoSort::Game::setInstance(&game);
 
-    game.run();
+    EcoSort::GameOptions options;
+
+    // Runs on its own, without a window or the game.
+    if (argc == 2 && std::string_view(argv[1]) == "--bench-queries") {
+        EcoSort::benchmarkSceneQueries();
+        return 0;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--headless") options.headless = true;
+        else if (arg == "--game") options.startInGame = true;
+        else if (arg == "--pipelined") options.pipelined = true;
+        else if (arg == "--gl41") options.forceGL41 = true;
+        else if (arg == "--present" && hasValue) {
+            std::string_view mode = argv[++i];
+            if (mode == "vsync") options.presentMode = EcoSort::PresentMode::VSYNC;
+            else if (mode == "adaptive") options.presentMode = EcoSort::PresentMode::ADAPTIVE_VSYNC;
+            else if (mode == "uncapped") options.presentMode = EcoSort::PresentMode::UNCAPPED;
+            else if (mode == "limited") options.presentMode = EcoSort::PresentMode::LIMITED;
+            else game.getLogger().warn("Unknown present mode: {}", mode);
+        }
+        else if (arg == "--depth-prepass" && hasValue) {
+            std::string_view mode = argv[++i];
+            if (mode == "auto") options.depthPrePass = EcoSort::DepthPrePassMode::AUTO;
+            else if (mode == "on") options.depthPrePass = EcoSort::DepthPrePassMode::ALWAYS;
+            else if (mode == "off") options.depthPrePass = EcoSort::DepthPrePassMode::NEVER;
+            else game.getLogger().warn("Unknown depth pre-pass mode: {}", mode);
+        }
+        else if (arg == "--render-path" && hasValue) {
+            std::string_view path = argv[++i];
+            if (path == "auto") options.renderPath = EcoSort::RenderPath::AUTO;
+            else if (path == "deferred") options.renderPath = EcoSort::RenderPath::DEFERRED;
+            else if (path == "forward") options.renderPath = EcoSort::RenderPath::FORWARD_PLUS;
+            else game.getLogger().warn("Unknown render path: {}", path);
+        }
+        else if (arg == "--lighting-scale" && hasValue) parseNumber(game, arg, argv[++i], options.lightingScale);
+        else if (arg == "--fps" && hasValue) parseNumber(game, arg, argv[++i], options.targetFrameRate);
+        else if (arg == "--frames-in-flight" && hasValue) parseNumber(game, arg, argv[++i], options.maxFramesInFlight);
+        else if (arg == "--capture" && hasValue) options.captureDirectory = argv[++i];
+        else if (arg == "--capture-frames" && hasValue) parseNumber(game, arg, argv[++i], options.captureFrames);
+        else if (arg == "--frames" && hasValue) parseNumber(game, arg, argv[++i], options.frameLimit);
+        else if (arg == "--timestep" && hasValue) parseNumber(game, arg, argv[++i], options.fixedTimestep);
+        else if (arg == "--width" && hasValue) parseNumber(game, arg, argv[++i], options.width);
+        else if (arg == "--height" && hasValue) parseNumber(game, arg, argv[++i], options.height);
+        else game.getLogger().warn("Unknown argument: {}", argv[i]);
+    }
+
+    game.run(options);
     
 }